@@ -0,0 +1,176 @@
+#!/usr/bin/env python3
+# Copyright (C) 2026  Stefan Fabian
+#
+# This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+
+"""Generates the input traces replayed by the input_replay_benchmark.
+
+The traces use the format written by the InputRecorder and target the widgets and QML items of the
+benchmark which are placed at fixed positions on a 1280x720 render panel. They are generated at
+build time, usage: generate_traces.py OUTPUT_DIRECTORY
+"""
+
+import os
+import struct
+import sys
+
+PANEL_WIDTH = 1280
+PANEL_HEIGHT = 720
+
+TRACE_MAGIC = 0x494F5248
+TRACE_VERSION = 1
+
+# QEvent::Type
+MOUSE_BUTTON_PRESS = 2
+MOUSE_BUTTON_RELEASE = 3
+MOUSE_MOVE = 5
+KEY_PRESS = 6
+KEY_RELEASE = 7
+WHEEL = 31
+
+LEFT_BUTTON = 0x1
+KEY_BACKSPACE = 0x01000003
+
+# The centers of the targets, see input_replay_benchmark.cpp and qml/benchmark_overlay.qml
+WIDGET_BUTTON = (120, 60)
+WIDGET_LINE_EDIT = (200, 116)
+WIDGET_SLIDER = (200, 166)
+WIDGET_LIST = (200, 350)
+QML_BUTTON = (920, 60)
+QML_TEXT_INPUT = (1000, 116)
+QML_LIST = (1000, 350)
+
+
+class TraceWriter:
+    def __init__(self):
+        self.data = bytearray(struct.pack('<IH', TRACE_MAGIC, TRACE_VERSION))
+        self.buttons = 0
+
+    def _header(self, dt_us, event_type, x, y):
+        self.data += struct.pack('<IHff', dt_us, event_type, x / PANEL_WIDTH, y / PANEL_HEIGHT)
+
+    def mouse(self, dt_us, event_type, pos, button=0):
+        if event_type == MOUSE_BUTTON_PRESS:
+            self.buttons |= button
+        elif event_type == MOUSE_BUTTON_RELEASE:
+            self.buttons &= ~button
+        self._header(dt_us, event_type, *pos)
+        self.data += struct.pack('<III', button, self.buttons, 0)
+
+    def move(self, start, end, steps, dt_us=8000):
+        for i in range(1, steps + 1):
+            t = i / steps
+            pos = (start[0] + (end[0] - start[0]) * t, start[1] + (end[1] - start[1]) * t)
+            self.mouse(dt_us, MOUSE_MOVE, pos)
+
+    def click(self, pos):
+        self.mouse(60000, MOUSE_BUTTON_PRESS, pos, LEFT_BUTTON)
+        self.mouse(90000, MOUSE_BUTTON_RELEASE, pos, LEFT_BUTTON)
+
+    def wheel(self, dt_us, pos, angle_y):
+        self._header(dt_us, WHEEL, *pos)
+        self.data += struct.pack('<hhII', 0, angle_y, self.buttons, 0)
+
+    def key(self, dt_us, event_type, key, text):
+        self._header(dt_us, event_type, 0, 0)
+        encoded = text.encode('utf-16-le')
+        self.data += struct.pack('<iIBI', key, 0, 0, len(encoded)) + encoded
+
+    def type_text(self, text):
+        for char in text:
+            key = ord(char.upper())
+            self.key(70000, KEY_PRESS, key, char)
+            self.key(50000, KEY_RELEASE, key, char)
+
+    def backspace(self, count):
+        for _ in range(count):
+            self.key(80000, KEY_PRESS, KEY_BACKSPACE, '\b')
+            self.key(40000, KEY_RELEASE, KEY_BACKSPACE, '\b')
+
+    def save(self, path):
+        with open(path, 'wb') as f:
+            f.write(self.data)
+
+
+def mouse_sweep():
+    # Hover over the whole panel row by row, i.e., over both overlays and empty space
+    trace = TraceWriter()
+    position = (0, 0)
+    for row in range(12):
+        y = 30 + row * 60
+        start, end = ((10, y), (1270, y)) if row % 2 == 0 else ((1270, y), (10, y))
+        trace.move(position, start, 10)
+        trace.move(start, end, 250)
+        position = end
+    return trace
+
+
+def clicks():
+    trace = TraceWriter()
+    position = (640, 360)
+    for target in [WIDGET_BUTTON, QML_BUTTON] * 10:
+        trace.move(position, target, 40)
+        trace.click(target)
+        position = target
+    # Drag the slider back and forth
+    trace.move(position, WIDGET_SLIDER, 40)
+    trace.mouse(60000, MOUSE_BUTTON_PRESS, WIDGET_SLIDER, LEFT_BUTTON)
+    left = (WIDGET_SLIDER[0] - 150, WIDGET_SLIDER[1])
+    right = (WIDGET_SLIDER[0] + 150, WIDGET_SLIDER[1])
+    trace.move(WIDGET_SLIDER, left, 50)
+    for _ in range(5):
+        trace.move(left, right, 100)
+        trace.move(right, left, 100)
+    trace.mouse(60000, MOUSE_BUTTON_RELEASE, left, LEFT_BUTTON)
+    return trace
+
+
+def typing():
+    text = 'The quick brown fox jumps over the lazy dog '
+    trace = TraceWriter()
+    position = (640, 360)
+    for target in [WIDGET_LINE_EDIT, QML_TEXT_INPUT]:
+        trace.move(position, target, 40)
+        trace.click(target)
+        position = target
+        for _ in range(3):
+            trace.type_text(text)
+            trace.backspace(10)
+    return trace
+
+
+def wheel():
+    trace = TraceWriter()
+    position = (640, 360)
+    for target in [WIDGET_LIST, QML_LIST]:
+        trace.move(position, target, 40)
+        position = target
+        for direction in [-120, 120] * 3:
+            for _ in range(40):
+                trace.wheel(16000, target, direction)
+        # End scrolled down, so that the benchmark can check that the lists received the events
+        for _ in range(10):
+            trace.wheel(16000, target, -120)
+    return trace
+
+
+if __name__ == '__main__':
+    if len(sys.argv) != 2:
+        sys.exit('Usage: generate_traces.py OUTPUT_DIRECTORY')
+    output_directory = sys.argv[1]
+    os.makedirs(output_directory, exist_ok=True)
+    mouse_sweep().save(os.path.join(output_directory, 'mouse_sweep.trace'))
+    clicks().save(os.path.join(output_directory, 'clicks.trace'))
+    typing().save(os.path.join(output_directory, 'typing.trace'))
+    wheel().save(os.path.join(output_directory, 'wheel.trace'))
@@ -0,0 +1,404 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+// Replays input traces against a QWidget and a QML overlay without rviz and prints the dispatch
+// latency percentiles per trace. For the synthetic traces, it also checks that the events had the
+// expected effect on the overlays.
+//
+// Usage: input_replay_benchmark [--repetitions N] [TRACE_OR_DIRECTORY...]
+// Without arguments, the traces generated at build time by generate_traces.py are replayed.
+
+#include "hector_rviz_overlay/events/input_replayer.hpp"
+#include "hector_rviz_overlay/overlay_manager.hpp"
+#include "hector_rviz_overlay/render/overlay_renderer.hpp"
+#include "hector_rviz_overlay/ui/qml_overlay.hpp"
+#include "hector_rviz_overlay/ui/qwidget_overlay.hpp"
+
+#include <QApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLPaintDevice>
+#include <QPushButton>
+#include <QQuickItem>
+#include <QScrollBar>
+#include <QSlider>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+using namespace hector_rviz_overlay;
+
+namespace
+{
+constexpr int PanelWidth = 1280;
+constexpr int PanelHeight = 720;
+constexpr int SettleTimeMs = 1000;
+
+/*!
+ * Renders all overlays into a single offscreen framebuffer. The renderer is only needed to create
+ * the render resources of the overlays and to lay them out, the result is never displayed.
+ * If no OpenGL context can be created, the overlays are painted into an image and the QML overlay
+ * is not available.
+ */
+class HeadlessOverlayRenderer : public OverlayRenderer
+{
+public:
+  explicit HeadlessOverlayRenderer( QWidget *render_panel ) : OverlayRenderer( render_panel ) { }
+
+  void renderFrame() { render(); }
+
+  void releaseResources() override
+  {
+    if ( gl_context_ != nullptr )
+      gl_context_->makeCurrent( surface_.get() );
+    releaseOverlays();
+    paint_device_.reset();
+    framebuffer_.reset();
+    if ( gl_context_ != nullptr )
+      gl_context_->doneCurrent();
+    gl_context_.reset();
+    surface_.reset();
+  }
+
+  QPaintDevice *paintDevice() noexcept override
+  {
+    if ( paint_device_ != nullptr )
+      return paint_device_.get();
+    return &image_;
+  }
+
+  QOpenGLFramebufferObject *framebufferObject() override
+  {
+    if ( framebuffer_ == nullptr )
+      throw std::logic_error( "The headless renderer has no framebuffer object." );
+    return framebuffer_.get();
+  }
+
+  bool framebufferObjectUpdated() noexcept override { return framebuffer_updated_; }
+
+  QOpenGLContext *context() override
+  {
+    if ( gl_context_ == nullptr )
+      throw std::logic_error( "The headless renderer has no OpenGL context." );
+    return gl_context_.get();
+  }
+
+protected:
+  void initialize() override
+  {
+    surface_ = std::make_unique<QOffscreenSurface>();
+    surface_->create();
+    gl_context_ = std::make_unique<QOpenGLContext>();
+    if ( !gl_context_->create() || !gl_context_->makeCurrent( surface_.get() ) ) {
+      QTextStream( stderr ) << "No OpenGL context available, the QML overlay is disabled.\n";
+      gl_context_.reset();
+    }
+  }
+
+  void redrawLastFrame() override { }
+
+  void prepareRender( int width, int height ) override
+  {
+    if ( gl_context_ == nullptr ) {
+      if ( image_.width() != width || image_.height() != height )
+        image_ = QImage( width, height, QImage::Format_ARGB32_Premultiplied );
+      return;
+    }
+    gl_context_->makeCurrent( surface_.get() );
+    if ( framebuffer_ == nullptr || framebuffer_->size() != QSize( width, height ) ) {
+      framebuffer_ = std::make_unique<QOpenGLFramebufferObject>(
+          width, height, QOpenGLFramebufferObject::CombinedDepthStencil );
+      paint_device_ = std::make_unique<QOpenGLPaintDevice>( width, height );
+      framebuffer_updated_ = true;
+    }
+  }
+
+  void beginOverlayRender( const Overlay & ) override
+  {
+    if ( framebuffer_ == nullptr ) {
+      image_.fill( Qt::transparent );
+      return;
+    }
+    framebuffer_->bind();
+    QOpenGLFunctions *functions = gl_context_->functions();
+    functions->glClearColor( 0, 0, 0, 0 );
+    functions->glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT );
+  }
+
+  void endOverlayRender( const Overlay & ) override { }
+
+  void beginComposition() override { }
+
+  void composeOverlay( const Overlay & ) override { }
+
+  void releaseOverlayLayer( const Overlay & ) override { }
+
+  void finishRender() override
+  {
+    if ( framebuffer_ != nullptr )
+      framebuffer_->release();
+    framebuffer_updated_ = false;
+  }
+
+  void hide() override { }
+
+private:
+  std::unique_ptr<QOffscreenSurface> surface_;
+  std::unique_ptr<QOpenGLContext> gl_context_;
+  std::unique_ptr<QOpenGLFramebufferObject> framebuffer_;
+  std::unique_ptr<QOpenGLPaintDevice> paint_device_;
+  QImage image_;
+  bool framebuffer_updated_ = false;
+};
+
+//! The widgets are placed at fixed positions that are targeted by the traces (generate_traces.py).
+QWidgetOverlayPtr createWidgetOverlay()
+{
+  auto overlay = std::make_shared<QWidgetOverlay>( "benchmark_widgets" );
+  QWidget *widget = overlay->widget();
+  auto *button = new QPushButton( "Apply", widget );
+  button->setObjectName( "button" );
+  button->setGeometry( 40, 40, 160, 40 );
+  button->setProperty( "clicks", 0 );
+  QObject::connect( button, &QPushButton::clicked, [button]() {
+    button->setProperty( "clicks", button->property( "clicks" ).toInt() + 1 );
+  } );
+  auto *line_edit = new QLineEdit( widget );
+  line_edit->setObjectName( "lineEdit" );
+  line_edit->setGeometry( 40, 100, 320, 32 );
+  auto *slider = new QSlider( Qt::Horizontal, widget );
+  slider->setGeometry( 40, 150, 320, 32 );
+  auto *list = new QListWidget( widget );
+  list->setObjectName( "list" );
+  list->setGeometry( 40, 200, 320, 300 );
+  for ( int i = 0; i < 200; ++i ) list->addItem( QString( "Item %1" ).arg( i ) );
+  return overlay;
+}
+
+//! The state of the targets of the synthetic traces. The QML values are 0 if QML is not loaded.
+struct TargetState {
+  int widget_clicks = 0;
+  int qml_clicks = 0;
+  QString widget_text;
+  QString qml_text;
+  int widget_scroll = 0;
+  double qml_scroll = 0;
+};
+
+QObject *qmlItem( QmlOverlay &qml_overlay, const QString &name )
+{
+  if ( qml_overlay.rootItem() == nullptr )
+    return nullptr;
+  return qml_overlay.rootItem()->findChild<QObject *>( name );
+}
+
+//! Resets the counters, texts and scroll positions of the targets.
+void resetTargets( QWidget *widget, QmlOverlay &qml_overlay )
+{
+  widget->findChild<QPushButton *>( "button" )->setProperty( "clicks", 0 );
+  widget->findChild<QLineEdit *>( "lineEdit" )->clear();
+  widget->findChild<QListWidget *>( "list" )->verticalScrollBar()->setValue( 0 );
+  if ( QObject *button = qmlItem( qml_overlay, "button" ) )
+    button->setProperty( "clicks", 0 );
+  if ( QObject *text_input = qmlItem( qml_overlay, "textInput" ) )
+    text_input->setProperty( "text", QString() );
+  if ( QObject *list = qmlItem( qml_overlay, "list" ) )
+    list->setProperty( "contentY", 0 );
+}
+
+TargetState readTargets( QWidget *widget, QmlOverlay &qml_overlay )
+{
+  TargetState state;
+  state.widget_clicks = widget->findChild<QPushButton *>( "button" )->property( "clicks" ).toInt();
+  state.widget_text = widget->findChild<QLineEdit *>( "lineEdit" )->text();
+  state.widget_scroll = widget->findChild<QListWidget *>( "list" )->verticalScrollBar()->value();
+  if ( QObject *button = qmlItem( qml_overlay, "button" ) )
+    state.qml_clicks = button->property( "clicks" ).toInt();
+  if ( QObject *text_input = qmlItem( qml_overlay, "textInput" ) )
+    state.qml_text = text_input->property( "text" ).toString();
+  if ( QObject *list = qmlItem( qml_overlay, "list" ) )
+    state.qml_scroll = list->property( "contentY" ).toDouble();
+  return state;
+}
+
+bool expect( bool condition, const QString &message )
+{
+  if ( !condition )
+    QTextStream( stderr ) << "Check failed: " << message << "\n";
+  return condition;
+}
+
+/*!
+ * Checks that the replayed events reached the targets in both overlays, e.g., a broken hit-testing
+ * or focus handling would only show up as suspiciously low latencies otherwise.
+ * The targets are reset before each trace. Only the traces of generate_traces.py are checked,
+ * identified by their file name.
+ * @return False if the state of the targets does not match the replayed trace.
+ */
+bool checkTraceResult( const QString &trace_name, int repetitions, bool check_qml,
+                       const TargetState &state )
+{
+  bool ok = true;
+  if ( trace_name == "clicks.trace" ) {
+    const int expected = 10 * repetitions;
+    ok &= expect( state.widget_clicks == expected,
+                  QString( "The widget button was clicked %1 times instead of %2." )
+                      .arg( state.widget_clicks )
+                      .arg( expected ) );
+    if ( check_qml ) {
+      ok &= expect( state.qml_clicks == expected,
+                    QString( "The QML button was clicked %1 times instead of %2." )
+                        .arg( state.qml_clicks )
+                        .arg( expected ) );
+    }
+  } else if ( trace_name == "typing.trace" ) {
+    const QString text = "The quick brown fox";
+    ok &= expect( state.widget_text.contains( text ),
+                  QString( "The line edit's text is '%1'." ).arg( state.widget_text ) );
+    if ( check_qml ) {
+      ok &= expect( state.qml_text.contains( text ),
+                    QString( "The QML text input's text is '%1'." ).arg( state.qml_text ) );
+    }
+  } else if ( trace_name == "wheel.trace" ) {
+    // The trace ends scrolled down
+    ok &= expect( state.widget_scroll > 0, "The widget list was not scrolled." );
+    if ( check_qml )
+      ok &= expect( state.qml_scroll > 0, "The QML list was not scrolled." );
+  }
+  return ok;
+}
+
+QStringList collectTraces( const QStringList &paths )
+{
+  QStringList traces;
+  for ( const QString &path : paths ) {
+    QFileInfo info( path );
+    if ( !info.isDir() ) {
+      traces.append( path );
+      continue;
+    }
+    QDir dir( path );
+    for ( const QString &name : dir.entryList( { "*.trace" }, QDir::Files, QDir::Name ) )
+      traces.append( dir.filePath( name ) );
+  }
+  return traces;
+}
+
+int runBenchmark( QWidget *render_panel, HeadlessOverlayRenderer *&renderer,
+                  const QStringList &traces, int repetitions )
+{
+  QTextStream out( stdout );
+  if ( traces.empty() ) {
+    QTextStream( stderr ) << "No input traces found.\n";
+    return 1;
+  }
+  OverlayManager &manager = OverlayManager::getSingleton();
+  QWidgetOverlayPtr widget_overlay = createWidgetOverlay();
+  auto qml_overlay = std::make_shared<QmlOverlay>( "benchmark_qml" );
+  qml_overlay->load( QDir( BENCHMARK_SOURCE_DIR ).absoluteFilePath( "qml/benchmark_overlay.qml" ) );
+  manager.addOverlay( widget_overlay );
+  manager.addOverlay( qml_overlay );
+  widget_overlay->show();
+  qml_overlay->show();
+
+  int result = 0;
+  for ( const QString &trace : traces ) {
+    // Render a frame first to lay out the overlays and create their render resources
+    renderer->renderFrame();
+    QCoreApplication::processEvents();
+    if ( qml_overlay->status() != QmlOverlay::Ok )
+      QTextStream( stderr ) << "Warning: The QML overlay is not loaded, only widgets are tested.\n";
+
+    InputReplayer replayer( render_panel );
+    if ( !replayer.load( trace ) ) {
+      result = 1;
+      continue;
+    }
+    resetTargets( widget_overlay->widget(), *qml_overlay );
+    InputReplayReport report = replayer.replay( repetitions );
+    out << QFileInfo( trace ).fileName() << " (" << replayer.events().size() << " events x "
+        << repetitions << ")\n"
+        << report.toString() << "\n";
+    out.flush();
+    // Let animations triggered by the events finish, e.g., the flicking of the QML list
+    QElapsedTimer settle_timer;
+    settle_timer.start();
+    while ( settle_timer.elapsed() < SettleTimeMs ) {
+      renderer->renderFrame();
+      QCoreApplication::processEvents();
+      QThread::msleep( 16 );
+    }
+    TargetState state = readTargets( widget_overlay->widget(), *qml_overlay );
+    const bool check_qml = qml_overlay->status() == QmlOverlay::Ok;
+    if ( !checkTraceResult( QFileInfo( trace ).fileName(), repetitions, check_qml, state ) )
+      result = 1;
+  }
+
+  manager.removeOverlay( qml_overlay );
+  manager.removeOverlay( widget_overlay );
+  return result;
+}
+} // namespace
+
+int main( int argc, char **argv )
+{
+  if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+    qputenv( "QT_QPA_PLATFORM", "offscreen" );
+  QApplication app( argc, argv );
+
+  int repetitions = 10;
+  QStringList paths;
+  QStringList arguments = QCoreApplication::arguments();
+  for ( int i = 1; i < arguments.size(); ++i ) {
+    if ( arguments[i] == "--repetitions" && i + 1 < arguments.size() ) {
+      repetitions = std::max( 1, arguments[++i].toInt() );
+      continue;
+    }
+    paths.append( arguments[i] );
+  }
+  if ( paths.empty() )
+    paths.append( BENCHMARK_TRACE_DIR );
+
+  QWidget render_panel;
+  render_panel.resize( PanelWidth, PanelHeight );
+  render_panel.show();
+  QApplication::setActiveWindow( &render_panel );
+
+  HeadlessOverlayRenderer *renderer = nullptr;
+  OverlayManager::getSingleton().initHeadless( &render_panel, [&render_panel, &renderer]() {
+    renderer = new HeadlessOverlayRenderer( &render_panel );
+    return renderer;
+  } );
+
+  // The renderer is released when the application quits
+  QTimer::singleShot( 0, [&]() {
+    QCoreApplication::exit( runBenchmark( &render_panel, renderer, collectTraces( paths ),
+                                          repetitions ) );
+  } );
+  return QApplication::exec();
+}
@@ -0,0 +1,61 @@
+import QtQuick 2.3
+
+// Loaded by the input_replay_benchmark. The items are placed at fixed positions that are targeted
+// by the traces, see generate_traces.py. Must not use the rviz context property since the
+// benchmark runs without rviz.
+Item {
+    id: page
+    anchors.fill: parent
+
+    Rectangle {
+        id: button
+        objectName: "button"
+        x: 840; y: 40; width: 160; height: 40
+        radius: 4
+        color: buttonArea.pressed ? "#1976d2" : buttonArea.containsMouse ? "#42a5f5" : "#90caf9"
+        property int clicks: 0
+
+        Text { anchors.centerIn: parent; text: "Clicked " + button.clicks + " times" }
+
+        MouseArea {
+            id: buttonArea
+            anchors.fill: parent
+            hoverEnabled: true
+            onClicked: button.clicks++
+        }
+    }
+
+    Rectangle {
+        x: 1040; y: 40; width: 40; height: 40
+        color: "#ef6c00"
+        RotationAnimation on rotation {
+            from: 0; to: 360; duration: 2000; loops: Animation.Infinite
+        }
+    }
+
+    Rectangle {
+        x: 840; y: 100; width: 320; height: 32
+        border.color: input.activeFocus ? "#1976d2" : "#9e9e9e"
+
+        TextInput {
+            id: input
+            objectName: "textInput"
+            anchors.fill: parent
+            anchors.margins: 6
+            selectByMouse: true
+        }
+    }
+
+    ListView {
+        objectName: "list"
+        x: 840; y: 200; width: 320; height: 300
+        clip: true
+        model: 200
+        delegate: Rectangle {
+            width: ListView.view.width; height: 24
+            color: delegateArea.containsMouse ? "#e3f2fd" : index % 2 ? "#fafafa" : "white"
+            Text { anchors.verticalCenter: parent.verticalCenter; x: 8; text: "Item " + index }
+            MouseArea { id: delegateArea; anchors.fill: parent; hoverEnabled: true }
+        }
+    }
+}
@@ -1,3 +1,44 @@
 # find package the Qt5 components otherwise Qt5 will be included without components
 # which will cause a build error
 find_package(Qt5 REQUIRED QUIET COMPONENTS Core Widgets Gui Quick Qml)
+
+# Compiles the given QML files into the target as ahead-of-time cached resources.
+# The files are available as qrc:/packages/<PACKAGE>/<path relative to the current source dir>,
+# which is what QmlOverlay::load resolves package://<PACKAGE>/<path> to. Hence, they are loaded
+# without compiling them at runtime and without Qt writing cache files next to the installed files.
+#
+#   hector_rviz_overlay_add_qml_resources(<target> [PACKAGE <package>] FILES <file>...)
+#
+# PACKAGE defaults to PROJECT_NAME. If Qt5QuickCompiler is not available, the files are still
+# embedded as resources but compiled at runtime.
+function(hector_rviz_overlay_add_qml_resources target)
+  cmake_parse_arguments(ARG "" "PACKAGE" "FILES" ${ARGN})
+  if (NOT ARG_PACKAGE)
+    set(ARG_PACKAGE ${PROJECT_NAME})
+  endif ()
+  if (NOT ARG_FILES)
+    message(FATAL_ERROR "hector_rviz_overlay_add_qml_resources: No FILES given for target ${target}.")
+  endif ()
+
+  set(qrc_content "<RCC>\n  <qresource prefix=\"/packages/${ARG_PACKAGE}\">\n")
+  foreach (qml_file ${ARG_FILES})
+    get_filename_component(absolute_path "${qml_file}" ABSOLUTE)
+    file(RELATIVE_PATH alias "${CMAKE_CURRENT_SOURCE_DIR}" "${absolute_path}")
+    string(APPEND qrc_content "    <file alias=\"${alias}\">${absolute_path}</file>\n")
+  endforeach ()
+  string(APPEND qrc_content "  </qresource>\n</RCC>\n")
+  # The resource compilers read the qrc file at configure time. It is only replaced if the content
+  # changed to avoid rebuilding the resources on every configure.
+  set(qrc_file "${CMAKE_CURRENT_BINARY_DIR}/${target}_qml_resources.qrc")
+  file(WRITE "${qrc_file}.in" "${qrc_content}")
+  configure_file("${qrc_file}.in" "${qrc_file}" COPYONLY)
+
+  find_package(Qt5QuickCompiler QUIET)
+  if (Qt5QuickCompiler_FOUND)
+    qtquick_compiler_add_resources(qml_resources "${qrc_file}")
+  else ()
+    message(WARNING "Qt5QuickCompiler not found! The QML files of ${target} are embedded but compiled at runtime.")
+    qt5_add_resources(qml_resources "${qrc_file}")
+  endif ()
+  target_sources(${target} PRIVATE ${qml_resources})
+endfunction()
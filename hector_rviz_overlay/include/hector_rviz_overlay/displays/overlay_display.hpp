@@ -24,6 +24,7 @@
 
 namespace rviz_common::properties
 {
+class EnumProperty;
 class FloatProperty;
 class IntProperty;
 } // namespace rviz_common::properties
@@ -67,6 +68,24 @@ protected slots:
    */
   virtual void onZIndexChanged();
 
+  /*!
+   * A Qt slot that is called whenever the render_priority_property_ is changed.
+   * The default implementation simply forwards the new priority to the overlay_ instance.
+   */
+  virtual void onRenderPriorityChanged();
+
+  /*!
+   * A Qt slot that is called whenever the max_update_rate_property_ is changed.
+   * The default implementation simply forwards the new rate to the overlay_ instance.
+   */
+  virtual void onMaxUpdateRateChanged();
+
+  /*!
+   * A Qt slot that is called whenever the hidden_policy_property_ or release_delay_property_ is
+   * changed. The default implementation forwards the new values to the overlay_ instance.
+   */
+  virtual void onHiddenPolicyChanged();
+
 protected:
   /*!
    * Creates the Overlay instance using createOverlay() and tries to add it to the OverlayManager.
@@ -96,6 +115,14 @@ protected:
   rviz_common::properties::IntProperty *z_index_property_;
   /*! A property that allows the user to change the scale of the Overlay. */
   rviz_common::properties::FloatProperty *scale_property_;
+  /*! A property that allows the user to change the render priority of the Overlay. */
+  rviz_common::properties::IntProperty *render_priority_property_;
+  /*! A property that allows the user to limit how often the Overlay is rendered. */
+  rviz_common::properties::FloatProperty *max_update_rate_property_;
+  /*! A property that determines what happens to the resources of the Overlay while it is hidden. */
+  rviz_common::properties::EnumProperty *hidden_policy_property_;
+  /*! A property for the time the Overlay has to be hidden before its resources are released. */
+  rviz_common::properties::FloatProperty *release_delay_property_;
   /*! A pointer to an instance of Overlay which is created in onInitialize(). */
   UiOverlayPtr overlay_;
 
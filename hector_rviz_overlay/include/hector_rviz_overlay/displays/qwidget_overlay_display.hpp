@@ -23,6 +23,7 @@
 
 namespace rviz_common::properties
 {
+class BoolProperty;
 class EditableEnumProperty;
 }
 
@@ -53,6 +54,9 @@ protected slots:
    */
   virtual void updateStyleSheet();
 
+  //! A Qt slot that is called whenever the rasterize_property_ or its child is changed.
+  void onRasterizeChanged();
+
 protected:
   void onInitialize() override;
 
@@ -67,6 +71,10 @@ protected:
 
   /*! A property that allows the user to apply a style sheet to an Overlay's top-level QWidget. */
   rviz_common::properties::EditableEnumProperty *style_sheet_property_;
+  /*! A property that toggles between QWidgetOverlay's Raster and Direct render mode. */
+  rviz_common::properties::BoolProperty *rasterize_property_;
+  /*! A child of rasterize_property_ that selects the ParallelRaster render mode. */
+  rviz_common::properties::BoolProperty *parallel_raster_property_;
   QWidgetOverlayPtr qwidget_overlay_;
 };
 } // namespace hector_rviz_overlay
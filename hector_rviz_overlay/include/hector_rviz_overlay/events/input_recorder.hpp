@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_INPUT_RECORDER_H
+#define HECTOR_RVIZ_OVERLAY_INPUT_RECORDER_H
+
+#include <QDataStream>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFile>
+#include <QObject>
+#include <QPointF>
+#include <QPointer>
+
+#include <vector>
+
+class QWidget;
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @brief A mouse, wheel or key event as stored in an input trace.
+ */
+struct RecordedInputEvent {
+  //! The time since the start of the recording in microseconds.
+  qint64 time_us = 0;
+  QEvent::Type type = QEvent::None;
+  //! The position relative to the render panel where (0, 0) is the top left and (1, 1) the bottom
+  //! right. Not used for key events.
+  QPointF position;
+  Qt::MouseButton button = Qt::NoButton;
+  Qt::MouseButtons buttons = Qt::NoButton;
+  Qt::KeyboardModifiers modifiers = Qt::NoModifier;
+  QPoint angle_delta;
+  int key = 0;
+  QString text;
+  bool auto_repeat = false;
+};
+
+/*!
+ * Reads an input trace written by the InputRecorder.
+ * @param path The path of the trace file.
+ * @param events Set to the events in the trace.
+ * @return False if the file could not be read or is not a valid trace.
+ */
+bool loadInputTrace( const QString &path, std::vector<RecordedInputEvent> &events );
+
+/*!
+ * @class InputRecorder
+ * @brief Records the raw mouse, wheel and key events that reach the OverlayManager to a file.
+ *
+ * Events are recorded when they are delivered to a window, i.e., before they are dispatched to
+ * widgets, with their positions relative to the render panel. Hence, a trace can be replayed using
+ * the InputReplayer even if the window has a different position or size.
+ *
+ * The recording is started by the OverlayManager if the environment variable
+ * HECTOR_RVIZ_OVERLAY_RECORD_INPUT is set to the path of the trace file.
+ */
+class InputRecorder : public QObject
+{
+  Q_OBJECT
+public:
+  //! @param render_panel The render panel the positions are relative to.
+  explicit InputRecorder( QWidget *render_panel );
+
+  ~InputRecorder() override;
+
+  /*!
+   * Starts recording to the given file. A previous recording is stopped.
+   * @param path The path of the trace file. Existing files are overwritten.
+   * @return False if the file could not be opened.
+   */
+  bool start( const QString &path );
+
+  //! Stops recording and closes the file.
+  void stop();
+
+  bool isRecording() const;
+
+  //! @return The number of events recorded since the last start.
+  size_t recordedEvents() const;
+
+protected:
+  bool eventFilter( QObject *receiver, QEvent *event ) override;
+
+private:
+  QPointer<QWidget> render_panel_;
+  QFile file_;
+  QDataStream stream_;
+  QElapsedTimer timer_;
+  qint64 last_time_us_ = 0;
+  size_t recorded_events_ = 0;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_INPUT_RECORDER_H
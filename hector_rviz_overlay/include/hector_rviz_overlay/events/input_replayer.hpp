@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_INPUT_REPLAYER_H
+#define HECTOR_RVIZ_OVERLAY_INPUT_REPLAYER_H
+
+#include "hector_rviz_overlay/events/input_recorder.hpp"
+
+#include <map>
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @brief Dispatch latency statistics of replayed events in microseconds.
+ */
+struct InputLatencyStats {
+  size_t count = 0;
+  double mean_us = 0;
+  double p50_us = 0;
+  double p90_us = 0;
+  double p99_us = 0;
+  double max_us = 0;
+};
+
+/*!
+ * @brief The result of InputReplayer::replay.
+ */
+struct InputReplayReport {
+  //! The statistics over all replayed events.
+  InputLatencyStats all;
+  //! The statistics per event type, e.g., QEvent::MouseMove.
+  std::map<QEvent::Type, InputLatencyStats> by_type;
+
+  //! @return A human readable table of the statistics.
+  QString toString() const;
+};
+
+/*!
+ * @class InputReplayer
+ * @brief Replays an input trace recorded by the InputRecorder and measures the dispatch latency.
+ *
+ * The events are sent to the window containing the render panel, i.e., they take the same path as
+ * the recorded events through the OverlayManager and the overlays' event handling. Each event is
+ * sent synchronously and the time until it returns is its dispatch latency. Events are replayed
+ * as fast as possible and without processing the event loop in between, hence, the results are
+ * deterministic as long as the overlays are in the same state as during the recording.
+ */
+class InputReplayer
+{
+public:
+  //! @param render_panel The render panel the recorded positions are relative to.
+  explicit InputReplayer( QWidget *render_panel );
+
+  /*!
+   * Loads the trace from the given file.
+   * @return False if the file could not be read. See loadInputTrace.
+   */
+  bool load( const QString &path );
+
+  const std::vector<RecordedInputEvent> &events() const;
+
+  void setEvents( std::vector<RecordedInputEvent> events );
+
+  /*!
+   * Replays the loaded events.
+   * @param repetitions How often the trace is replayed. All repetitions are part of the report.
+   * @return The dispatch latency statistics.
+   */
+  InputReplayReport replay( int repetitions = 1 );
+
+private:
+  QPointer<QWidget> render_panel_;
+  std::vector<RecordedInputEvent> events_;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_INPUT_REPLAYER_H
@@ -20,6 +20,8 @@
 
 #include <QPoint>
 
+#include <memory>
+
 class QEvent;
 class QKeyEvent;
 class QMouseEvent;
@@ -29,6 +31,7 @@ class QWidget;
 
 namespace hector_rviz_overlay
 {
+class WidgetHitTestCache;
 
 /*!
  * Manages the event passing for QWidgets.
@@ -59,6 +62,7 @@ protected:
   void sendHoverEvents( QWidget *child, QPoint pos, QMouseEvent *event );
 
   QWidget *widget_ = nullptr;
+  std::unique_ptr<WidgetHitTestCache> hit_test_cache_;
   float scale_ = 1.0f;
 
   QWidget *mouse_over_widget_ = nullptr;
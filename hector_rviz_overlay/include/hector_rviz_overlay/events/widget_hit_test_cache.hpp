@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_WIDGET_HIT_TEST_CACHE_H
+#define HECTOR_RVIZ_OVERLAY_WIDGET_HIT_TEST_CACHE_H
+
+#include <QObject>
+#include <QPointer>
+#include <QRect>
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class QWidget;
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class WidgetHitTestCache
+ * @brief Caches the rectangles of the visible child widgets of a widget for fast hit-testing.
+ *
+ * The visible descendants are flattened into a list ordered from top to bottom and sorted into a
+ * uniform grid. A cell only contains the widgets up to the first one that covers it completely
+ * since widgets below it can not be hit in that cell.
+ * The cache is rebuilt lazily after a widget in the hierarchy was moved, resized, shown, hidden,
+ * added, removed or restacked.
+ * Qt does not send Move and Resize events to hidden widgets, e.g., if the overlay is resized with
+ * the render panel or laid out by QWidget::render, hence, the geometries of the root and the
+ * collected widgets are compared to a snapshot on each query as well.
+ */
+class WidgetHitTestCache : public QObject
+{
+  Q_OBJECT
+public:
+  explicit WidgetHitTestCache( QWidget *root );
+
+  ~WidgetHitTestCache() override;
+
+  /*!
+   * Equivalent to QWidget::childAt of the root widget.
+   * @param pos The position in the coordinates of the root widget.
+   * @param local_pos If not null, set to the position in the coordinates of the returned widget.
+   * @return The topmost visible child widget at the given position or nullptr if there is none.
+   */
+  QWidget *childAt( const QPoint &pos, QPoint *local_pos = nullptr );
+
+  /*!
+   * Equivalent to widget->mapFrom( root, pos ) but uses the cached offset if available.
+   * @param widget A descendant of the root widget.
+   * @param pos The position in the coordinates of the root widget.
+   * @return The position in the coordinates of the given widget.
+   */
+  QPoint mapFromRoot( QWidget *widget, const QPoint &pos );
+
+  //! Marks the cache as outdated. It is rebuilt on the next query.
+  void invalidate();
+
+protected:
+  bool eventFilter( QObject *watched, QEvent *event ) override;
+
+private:
+  struct Entry {
+    QPointer<QWidget> widget;
+    //! The rectangle of the widget clipped to its parents in root coordinates.
+    QRect rect;
+    //! The top-left of the widget in root coordinates.
+    QPoint offset;
+  };
+
+  //! Rebuilds the cache if it was invalidated or a geometry changed since the last rebuild.
+  void ensureUpToDate();
+
+  void rebuild();
+
+  void collect( QWidget *parent, const QPoint &offset, const QRect &clip );
+
+  static constexpr int CellSize = 64;
+
+  QWidget *root_;
+  std::vector<Entry> entries_;
+  //! The geometries of all collected widgets, including the hidden ones, at the last rebuild.
+  std::vector<std::pair<QPointer<QWidget>, QRect>> geometries_;
+  QSize root_size_;
+  std::unordered_map<const QWidget *, size_t> entry_indices_;
+  //! For each cell, the indices of the entries that intersect it ordered from top to bottom.
+  std::vector<std::vector<unsigned>> cells_;
+  int columns_ = 0;
+  int rows_ = 0;
+  //! Masks are rare, hence, if there is a widget with a mask, we simply fall back to Qt.
+  bool has_masks_ = false;
+  bool outdated_ = true;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_WIDGET_HIT_TEST_CACHE_H
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_INLINE_FUNCTION_H
+#define HECTOR_RVIZ_OVERLAY_INLINE_FUNCTION_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class InlineFunction
+ * @brief A move-only void() callable that stores the callable inline instead of on the heap.
+ *
+ * Unlike std::function, constructing an InlineFunction never allocates. Callables that don't fit
+ * into the storage are rejected at compile time, hence, larger data should be captured by pointer,
+ * e.g., as a std::shared_ptr or std::unique_ptr, which is supported since it does not need to be
+ * copyable.
+ *
+ * @tparam Capacity The size of the inline storage in bytes.
+ */
+template<size_t Capacity>
+class InlineFunction
+{
+public:
+  InlineFunction() = default;
+
+  //! Implicit, so that lambdas can be passed wherever an InlineFunction is expected.
+  template<typename Callable, typename = std::enable_if_t<
+                                  !std::is_same<std::decay_t<Callable>, InlineFunction>::value>>
+  InlineFunction( Callable &&callable )
+  {
+    using Type = std::decay_t<Callable>;
+    static_assert( sizeof( Type ) <= Capacity,
+                   "The callable does not fit into the inline storage. Capture large data by "
+                   "pointer, e.g., using a std::shared_ptr." );
+    static_assert( alignof( Type ) <= alignof( std::max_align_t ),
+                   "The callable is over-aligned for the inline storage." );
+    static_assert( std::is_nothrow_move_constructible<Type>::value,
+                   "The callable has to be nothrow move constructible." );
+    new ( &storage_ ) Type( std::forward<Callable>( callable ) );
+    operations_ = &OperationsFor<Type>::operations;
+  }
+
+  InlineFunction( InlineFunction &&other ) noexcept { moveFrom( other ); }
+
+  InlineFunction &operator=( InlineFunction &&other ) noexcept
+  {
+    if ( this == &other )
+      return *this;
+    reset();
+    moveFrom( other );
+    return *this;
+  }
+
+  InlineFunction( const InlineFunction & ) = delete;
+
+  InlineFunction &operator=( const InlineFunction & ) = delete;
+
+  ~InlineFunction() { reset(); }
+
+  explicit operator bool() const { return operations_ != nullptr; }
+
+  //! Calls the callable. Must not be called on an empty InlineFunction.
+  void operator()() { operations_->invoke( &storage_ ); }
+
+  //! Destroys the callable, leaving this InlineFunction empty.
+  void reset()
+  {
+    if ( operations_ == nullptr )
+      return;
+    operations_->destroy( &storage_ );
+    operations_ = nullptr;
+  }
+
+private:
+  struct Operations {
+    void ( *invoke )( void *storage );
+    //! Move constructs the callable in target from source and destroys the callable in source.
+    void ( *move )( void *target, void *source );
+    void ( *destroy )( void *storage );
+  };
+
+  template<typename Type>
+  struct OperationsFor {
+    static void invoke( void *storage ) { ( *static_cast<Type *>( storage ) )(); }
+
+    static void move( void *target, void *source )
+    {
+      new ( target ) Type( std::move( *static_cast<Type *>( source ) ) );
+      static_cast<Type *>( source )->~Type();
+    }
+
+    static void destroy( void *storage ) { static_cast<Type *>( storage )->~Type(); }
+
+    static constexpr Operations operations = { &invoke, &move, &destroy };
+  };
+
+  void moveFrom( InlineFunction &other )
+  {
+    if ( other.operations_ == nullptr )
+      return;
+    other.operations_->move( &storage_, &other.storage_ );
+    operations_ = other.operations_;
+    other.operations_ = nullptr;
+  }
+
+  std::aligned_storage_t<Capacity, alignof( std::max_align_t )> storage_;
+  const Operations *operations_ = nullptr;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_INLINE_FUNCTION_H
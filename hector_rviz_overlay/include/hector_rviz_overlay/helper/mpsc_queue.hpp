@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_MPSC_QUEUE_H
+#define HECTOR_RVIZ_OVERLAY_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class MpscQueue
+ * @brief A bounded lock-free queue for multiple producers and a single consumer.
+ *
+ * Based on Dmitry Vyukov's bounded MPMC queue. Each slot has a sequence number which tells
+ * producers and the consumer whether the slot is free or contains a value, hence pushing and
+ * popping never block and never allocate.
+ * tryPush may be called from any thread, tryPop must only be called from a single thread at a time.
+ *
+ * @tparam T The type of the elements. Has to be default constructible and move assignable.
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+  /*!
+   * @param capacity The maximum number of elements. Rounded up to the next power of two.
+   */
+  explicit MpscQueue( size_t capacity )
+  {
+    size_t size = 2;
+    while ( size < capacity ) size <<= 1;
+    mask_ = size - 1;
+    buffer_.reset( new Cell[size] );
+    for ( size_t i = 0; i < size; ++i ) buffer_[i].sequence.store( i, std::memory_order_relaxed );
+  }
+
+  MpscQueue( const MpscQueue & ) = delete;
+
+  MpscQueue &operator=( const MpscQueue & ) = delete;
+
+  size_t capacity() const { return mask_ + 1; }
+
+  /*!
+   * Thread-safe.
+   * @return False if the queue is full in which case the value is not moved from.
+   */
+  bool tryPush( T &&value )
+  {
+    size_t pos = enqueue_pos_.load( std::memory_order_relaxed );
+    Cell *cell;
+    for ( ;; ) {
+      cell = &buffer_[pos & mask_];
+      size_t sequence = cell->sequence.load( std::memory_order_acquire );
+      intptr_t diff = static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( pos );
+      if ( diff == 0 ) {
+        if ( enqueue_pos_.compare_exchange_weak( pos, pos + 1, std::memory_order_relaxed ) )
+          break;
+      } else if ( diff < 0 ) {
+        return false;
+      } else {
+        pos = enqueue_pos_.load( std::memory_order_relaxed );
+      }
+    }
+    cell->value = std::move( value );
+    cell->sequence.store( pos + 1, std::memory_order_release );
+    return true;
+  }
+
+  /*!
+   * Must only be called by the consumer.
+   * @return False if the queue is empty.
+   */
+  bool tryPop( T &value )
+  {
+    Cell *cell = &buffer_[dequeue_pos_ & mask_];
+    size_t sequence = cell->sequence.load( std::memory_order_acquire );
+    if ( static_cast<intptr_t>( sequence ) - static_cast<intptr_t>( dequeue_pos_ + 1 ) < 0 )
+      return false;
+    value = std::move( cell->value );
+    // Release resources held by the moved-from value now instead of when the slot is reused
+    cell->value = T();
+    cell->sequence.store( dequeue_pos_ + mask_ + 1, std::memory_order_release );
+    ++dequeue_pos_;
+    return true;
+  }
+
+private:
+  struct Cell {
+    std::atomic<size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> buffer_;
+  size_t mask_;
+  // Separate cache lines to avoid false sharing between producers and the consumer
+  alignas( 64 ) std::atomic<size_t> enqueue_pos_{ 0 };
+  alignas( 64 ) size_t dequeue_pos_ = 0;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_MPSC_QUEUE_H
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_PAINTER_COMMAND_LIST_H
+#define HECTOR_RVIZ_OVERLAY_PAINTER_COMMAND_LIST_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QColor>
+#include <QPointF>
+#include <QRectF>
+#include <QString>
+
+class QPainter;
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class PainterCommandList
+ * @brief A list of primitive draw commands that can be recorded on any thread and replayed later
+ *   using a QPainter.
+ *
+ * The commands and their data, e.g., the points of a polyline or the characters of a text, are
+ * stored back to back in a single arena. Clearing the list keeps the capacity of the arena, hence,
+ * a list that is cleared and recorded again every frame does not allocate once it has reached the
+ * size of the largest frame.
+ * The list itself is not synchronized. Use PainterOverlay to pass lists between threads.
+ */
+class PainterCommandList
+{
+public:
+  //! Removes all commands but keeps the memory of the arena for the next recording.
+  void clear();
+
+  //! Reserves at least the given number of bytes in the arena.
+  void reserve( size_t bytes ) { data_.reserve( bytes ); }
+
+  bool empty() const { return data_.empty(); }
+
+  //! @return The number of recorded commands.
+  size_t commandCount() const { return command_count_; }
+
+  //! @return The number of bytes used by the recorded commands.
+  size_t byteSize() const { return data_.size(); }
+
+  //! @return The number of bytes that can be recorded without allocating.
+  size_t capacity() const { return data_.capacity(); }
+
+  /*!
+   * Sets the pen used for outlines, lines and text. A fully transparent color disables the pen.
+   * @param width The width of the pen in pixels. 0 is a cosmetic pen with a width of one pixel.
+   */
+  void setPen( const QColor &color, qreal width = 1, Qt::PenStyle style = Qt::SolidLine );
+
+  //! Sets the brush used to fill shapes. A fully transparent color disables filling.
+  void setBrush( const QColor &color );
+
+  //! Sets the pixel size and weight of the painter's font for subsequent text commands.
+  void setFont( int pixel_size, bool bold = false );
+
+  void setOpacity( qreal opacity );
+
+  //! Saves the painter state (pen, brush, font, opacity and transform). @see QPainter::save()
+  void save();
+
+  //! Restores the state saved by the matching save(). @see QPainter::restore()
+  void restore();
+
+  void translate( qreal dx, qreal dy );
+
+  //! @param degrees The clockwise rotation in degrees.
+  void rotate( qreal degrees );
+
+  void scale( qreal sx, qreal sy );
+
+  void drawLine( const QPointF &p1, const QPointF &p2 );
+
+  void drawRect( const QRectF &rect );
+
+  void drawEllipse( const QPointF &center, qreal rx, qreal ry );
+
+  /*!
+   * @param rect The bounding rectangle of the ellipse the arc is part of.
+   * @param start_angle The start angle in degrees. 0 is at the three o'clock position.
+   * @param span_angle The counter-clockwise span of the arc in degrees.
+   */
+  void drawArc( const QRectF &rect, qreal start_angle, qreal span_angle );
+
+  void drawPolyline( const QPointF *points, int count );
+
+  void drawPolygon( const QPointF *points, int count );
+
+  //! @param position The left end of the base line of the text.
+  void drawText( const QPointF &position, const QString &text );
+
+  //! @param flags A combination of Qt::AlignmentFlag and Qt::TextFlag.
+  void drawText( const QRectF &rect, int flags, const QString &text );
+
+  //! Replays all commands in the order they were recorded using the given painter.
+  void replay( QPainter &painter ) const;
+
+private:
+  enum class CommandType : uint16_t;
+
+  void append( CommandType type, const void *payload, size_t payload_size,
+               const void *extra = nullptr, size_t extra_size = 0 );
+
+  std::vector<unsigned char> data_;
+  size_t command_count_ = 0;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_PAINTER_COMMAND_LIST_H
@@ -43,6 +43,8 @@ class QmlRvizContext : public QObject
   Q_PROPERTY( bool isFullscreen READ isFullscreen WRITE setIsFullscreen NOTIFY isFullscreenChanged )
   Q_PROPERTY( QString fixedFrame READ fixedFrame WRITE setFixedFrame NOTIFY fixedFrameChanged )
   Q_PROPERTY( QObject *toolManager READ toolManager CONSTANT )
+  Q_PROPERTY( QString powerState READ powerState NOTIFY powerStateChanged )
+  Q_PROPERTY( bool lowPower READ lowPower NOTIFY powerStateChanged )
   // @formatter:on
 public:
   explicit QmlRvizContext( rviz_common::DisplayContext *context, const Overlay *overlay,
@@ -66,6 +68,18 @@ public:
 
   void setFixedFrame( const QString &frame );
 
+  /*!
+   * @return The power state of the OverlayManager as string, i.e., "active", "inactive" or
+   *   "minimized".
+   */
+  QString powerState() const;
+
+  /*!
+   * Convenience property for QML, e.g., to stop timers using <tt>running: !rviz.lowPower</tt>.
+   * @return True if rviz is not the active application or minimized.
+   */
+  bool lowPower() const;
+
   void load( const rviz_common::Config &config );
 
   void setConfigurationPropertyParent( rviz_common::properties::Property *parent );
@@ -184,6 +198,8 @@ signals:
 
   void fixedFrameChanged();
 
+  void powerStateChanged();
+
 private slots:
   void onWindowStateChanged( Qt::WindowState state );
 
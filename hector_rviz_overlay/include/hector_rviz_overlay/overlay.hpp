@@ -18,6 +18,9 @@
 #ifndef HECTOR_RVIZ_OVERLAY_OVERLAY_H
 #define HECTOR_RVIZ_OVERLAY_OVERLAY_H
 
+#include "hector_rviz_overlay/helper/inline_function.hpp"
+
+#include <atomic>
 #include <memory>
 
 #include <QObject>
@@ -30,6 +33,9 @@ namespace hector_rviz_overlay
 
 class Renderer;
 
+template<typename T>
+class MpscQueue;
+
 /*!
  * @class Overlay
  * @brief A base class for different kinds of overlays.
@@ -43,6 +49,25 @@ class Overlay : public QObject
 {
   Q_OBJECT
 public:
+  //! The maximum size of the captures of a function passed to queueUpdate in bytes.
+  static constexpr size_t UpdateFunctionSize = 64;
+
+  //! A function queued using queueUpdate. Stores its captures inline, i.e., without allocating.
+  using UpdateFunction = InlineFunction<UpdateFunctionSize>;
+
+  //! Determines what happens to the resources of an overlay while it is hidden.
+  enum HiddenPolicy {
+    //! The overlay is still updated and keeps all of its resources. (Default)
+    KeepWarm,
+    //! The overlay is no longer updated but keeps its resources to be shown again instantly.
+    //! QmlOverlays also pause the animations and timers of their scene.
+    Suspend,
+    //! Like Suspend but the render resources and the layer are released after the release delay
+    //! and restored when the overlay is shown again.
+    ReleaseWhenHidden
+  };
+  Q_ENUM( HiddenPolicy )
+
   /*!
    * The name passed here can differ from the name the overlay will have after it is passed to the
    * OverlayManager if when passing it to the OverlayManager it is specified that it should use a
@@ -84,6 +109,8 @@ public:
    * Handles events passed by the OverlayManager. Events with locations, e.g., MouseEvents will be adjusted so that the
    * local position is relative to the top left of the render panel (usually equivalent to the top left of the overlay).
    * The scale, however, is not treated by the OverlayManager and has to be handled by the overlays themselves.
+   * A FocusIn event is passed when the overlay becomes the receiver of key events, i.e., when it handled
+   * a mouse press, and a FocusOut event when it loses the focus.
    *
    * @param event The event that is passed
    * @return Whether the event was handled/consumed by the overlay or may propagate to the next overlay or rviz.
@@ -105,11 +132,12 @@ public:
 
   /*!
    * Updates the name of the overlay instance.
-   * <b>Do NOT change the overlay's name after the OverlayManager knows about it.</b>
    * This method is usually used to generate a unique name if an overlay with this name already exists in the OverlayManager.
+   * If the overlay is renamed after it was added to the OverlayManager, the name is not made
+   * unique and if another overlay already has this name, getByName keeps returning the other one.
    * @param value The new name
    */
-  void setName( const std::string &value ) { name_ = value; }
+  void setName( const std::string &value );
 
   /*!
    * Convenience function for setIsVisible( true ).
@@ -168,7 +196,86 @@ public:
    * When overriding this method make sure to factor in the value of the base implementation.
    * @return True if the overlay is dirty and needs to be rendered anew, false otherwise.
    */
-  virtual bool isDirty() const { return is_dirty_; }
+  virtual bool isDirty() const { return is_dirty_.load( std::memory_order_acquire ); }
+
+  /*!
+   * Overlays that return true are rendered at the reduced render resolution of the renderer, if
+   * set, and upscaled when the layers are composed. These overlays have to apply
+   * Renderer::resolutionScale() in addition to their scale when rendering.
+   * @return Whether the overlay can be rendered at a reduced resolution. Default: false
+   */
+  virtual bool supportsResolutionScale() const { return false; }
+
+  /*!
+   * If the rendering of all dirty overlays does not fit into the frame time budget of the renderer,
+   * overlays with a higher priority are rendered first. Overlays that are deferred keep showing
+   * their last rendered content and gain one priority level per 100ms they have been waiting,
+   * hence, lower priority overlays are delayed but not starved. Default: 0
+   * @return The render priority of this overlay.
+   */
+  int renderPriority() const { return render_priority_; }
+
+  /*!
+   * @see renderPriority()
+   * @param value The new render priority. Higher values are rendered first.
+   */
+  void setRenderPriority( int value ) { render_priority_ = value; }
+
+  /*!
+   * Limits how often the overlay is rendered. Render requests in between are coalesced and the last
+   * rendered content is shown until the next render. For QmlOverlays, only polishing, syncing and
+   * rendering the scene is limited. Animations are shared by all overlays and still advanced every
+   * frame, hence, bindings and scripts depending on animated properties are evaluated at full rate.
+   * @return The maximum number of renders per second. 0 means unlimited (default).
+   */
+  float maxUpdateRate() const { return max_update_rate_; }
+
+  /*!
+   * @see maxUpdateRate()
+   * @param value The maximum number of renders per second. 0 for unlimited.
+   */
+  void setMaxUpdateRate( float value ) { max_update_rate_ = value < 0 ? 0 : value; }
+
+  /*!
+   * @see HiddenPolicy
+   * @return What happens to the resources of the overlay while it is hidden. Default: KeepWarm
+   */
+  HiddenPolicy hiddenPolicy() const { return hidden_policy_; }
+
+  //! @see hiddenPolicy()
+  void setHiddenPolicy( HiddenPolicy value );
+
+  /*!
+   * Only used with the ReleaseWhenHidden policy.
+   * @return The time in seconds the overlay has to be hidden before its resources are released.
+   */
+  float releaseDelay() const { return release_delay_; }
+
+  //! @see releaseDelay()
+  void setReleaseDelay( float value ) { release_delay_ = value < 0 ? 0 : value; }
+
+  /*!
+   * Queues a function that is executed on the render thread before the next update and marks the
+   * overlay dirty.
+   * This method is thread-safe, lock-free and only allocates the queue on the first call, hence, it
+   * can be used to pass data from ROS callbacks running on other threads without a round-trip
+   * through the Qt event loop.
+   * The captures of the function are stored inline and may not exceed UpdateFunctionSize bytes
+   * which is checked at compile time. Larger states should be captured by pointer.
+   *
+   * @param update The function that is executed on the render thread, e.g., applying a new state.
+   * @return False if the queue is full (see UpdateQueueCapacity) and the update was dropped.
+   */
+  bool queueUpdate( UpdateFunction update );
+
+  /*!
+   * Executes all updates queued using queueUpdate. Called by the renderer once per frame before
+   * update.
+   */
+  void processQueuedUpdates();
+
+  //! The maximum number of updates that can be queued between two frames.
+  static constexpr size_t UpdateQueueCapacity = 1024;
 
 signals:
 
@@ -177,6 +284,12 @@ signals:
    */
   void visibilityChanged();
 
+  //! This signal is fired after the name changed.
+  void nameChanged( const std::string &old_name );
+
+  //! This signal is fired after the hidden policy changed.
+  void hiddenPolicyChanged();
+
 protected:
   /*!
    * This method has to be implemented in subclasses.
@@ -187,7 +300,7 @@ protected:
    */
   virtual void renderImpl( Renderer *renderer ) = 0;
 
-  //! Marks the overlay as dirty to make sure it is re-rendered in the next render
+  //! Marks the overlay as dirty to make sure it is re-rendered in the next render. Thread-safe.
   void requestRender();
 
 private:
@@ -195,7 +308,13 @@ private:
   QRect geometry_;
   float scale_ = 1.0f;
   bool is_visible_ = true;
-  bool is_dirty_ = true;
+  int render_priority_ = 0;
+  float max_update_rate_ = 0;
+  HiddenPolicy hidden_policy_ = KeepWarm;
+  float release_delay_ = 30;
+  std::atomic<bool> is_dirty_{ true };
+  //! Allocated by the first call to queueUpdate.
+  std::atomic<MpscQueue<UpdateFunction> *> update_queue_{ nullptr };
 };
 
 typedef std::shared_ptr<Overlay> OverlayPtr;
@@ -19,24 +19,32 @@
 #define HECTOR_RVIZ_OVERLAY_OVERLAY_MANAGER_H
 
 #include "hector_rviz_overlay/popup/popup_overlay.hpp"
+#include "hector_rviz_overlay/render/overlay_render_stats.hpp"
 #include "hector_rviz_overlay/ui/ui_overlay.hpp"
 
+#include <functional>
+#include <memory>
 #include <mutex>
+#include <unordered_map>
 
 #include <QImage>
+#include <QPointer>
+#include <QTimer>
 
 class QKeyEvent;
 class QMouseEvent;
 class QWheelEvent;
+class QWidget;
+class QWindow;
 
 namespace rviz_common
 {
 class DisplayContext;
-class RenderPanel;
 } // namespace rviz_common
 
 namespace hector_rviz_overlay
 {
+class InputRecorder;
 class OverlayRenderer;
 
 /*!
@@ -52,6 +60,43 @@ class OverlayManager : public QObject
   Q_OBJECT
 
 public:
+  enum PowerState {
+    //! rviz is the active application. Overlays are rendered without additional limits.
+    PowerActive,
+    //! rviz is visible but not the active application, e.g., another application has the focus.
+    PowerInactive,
+    //! rviz is minimized or its window is not exposed, i.e., nothing of it is visible.
+    PowerMinimized
+  };
+  Q_ENUM( PowerState )
+
+  /*!
+   * @brief Determines how rendering is throttled depending on the PowerState.
+   */
+  struct PowerPolicy {
+    //! If false, overlays are always rendered as if rviz was active.
+    bool enabled = true;
+    //! The maximum update rate of overlays and animations while inactive in Hz. 0 for unlimited.
+    float inactive_max_update_rate = 5;
+    //! Whether rendering and animations are suspended entirely while minimized.
+    bool suspend_when_minimized = true;
+  };
+
+  /*!
+   * @brief Determines the resolution overlays are rendered at.
+   * @see OverlayRenderer::renderResolution()
+   */
+  struct ResolutionPolicy {
+    //! The fraction of the native resolution overlays are rendered at. (0.25 to 1)
+    float resolution = 1;
+    //! Whether the resolution is lowered automatically while rendering exceeds the target time.
+    bool adaptive = false;
+    //! The lowest resolution the adaptive resolution may use.
+    float min_resolution = 0.5f;
+    //! The average time in ms that may be spent rendering overlays per frame.
+    double target_render_time = 4;
+  };
+
   // This makes sure that we don't get copies accidentally.
   OverlayManager( OverlayManager const & ) = delete;
 
@@ -74,6 +119,18 @@ public:
    */
   void init( rviz_common::DisplayContext *context );
 
+  //! Creates the renderer for the overlays when the first overlay is added.
+  using RendererFactory = std::function<OverlayRenderer *()>;
+
+  /*!
+   * Initializes the OverlayManager without rviz, e.g., to benchmark the event handling headless.
+   * Does nothing if the OverlayManager is already initialized.
+   * Overlays that need the display context, e.g., OverlayDisplays, can not be used in this mode.
+   * @param render_panel The widget that receives the input and on which the overlays are drawn.
+   * @param renderer_factory Creates the renderer that is used instead of OverlayRenderer::create.
+   */
+  void initHeadless( QWidget *render_panel, RendererFactory renderer_factory );
+
   /*!
    * Adds the overlay to the collection of overlays managed by this class.
    * If an overlay with the same name already exists and \p unique_name_if_exists is false, the method fails.
@@ -135,10 +192,99 @@ public:
    */
   void moveToBack( const std::string &name );
 
+  /*!
+   * Starts a transaction. Until the matching commitTransaction(), adding or removing overlays and
+   * z-index changes will not re-sort the overlays or the render order each time.
+   * Instead, the overlays are sorted once in a single pass when the transaction is committed.
+   * Transactions can be nested, in which case only the outermost commit applies the changes.
+   *
+   * Use this when adding or removing many overlays at once, e.g., when loading a config.
+   */
+  void beginTransaction();
+
+  /*!
+   * Commits a transaction started with beginTransaction().
+   * @see beginTransaction()
+   */
+  void commitTransaction();
+
+  /*!
+   * The time in ms that may be spent on rendering overlays per frame. Overlays that do not fit are
+   * deferred to later frames and keep showing their last rendered content.
+   * @see OverlayRenderer::frameTimeBudget()
+   * @return The frame time budget in ms. 0 means unlimited (default).
+   */
+  double frameTimeBudget() const;
+
+  /*!
+   * @see frameTimeBudget()
+   * @param value The frame time budget in ms. 0 for unlimited.
+   */
+  void setFrameTimeBudget( double value );
+
+  /*!
+   * @param name The name of the overlay.
+   * @return The render statistics of the overlay with the given name or default values if it
+   *   doesn't exist or was not rendered, yet.
+   */
+  OverlayRenderStats renderStats( const std::string &name ) const;
+
+  /*!
+   * When the last overlay is removed, the renderer and its GPU resources are kept for this period,
+   * so that adding an overlay again, e.g., when toggling a display or reloading a config, does not
+   * have to recreate the render context, textures and framebuffers.
+   * @return The time in ms after which the renderer is destroyed if there are no overlays. Default: 10000
+   */
+  int idleTeardownTimeout() const;
+
+  /*!
+   * @see idleTeardownTimeout()
+   * @param value The timeout in ms. 0 destroys the renderer as soon as the last overlay is removed.
+   */
+  void setIdleTeardownTimeout( int value );
+
+  /*!
+   * Whether hidden overlays are rendered once offscreen in idle frames after startup to avoid a
+   * hitch when they are shown for the first time.
+   * @see OverlayRenderer::warmUpEnabled()
+   * @return True if hidden overlays are warmed up. Default: false
+   */
+  bool warmUpEnabled() const;
+
+  //! @see warmUpEnabled()
+  void setWarmUpEnabled( bool value );
+
+  /*!
+   * The power state is derived from the application state and the state of rviz's main window.
+   * Overlays can use it (or QmlRvizContext's powerState in QML) to suspend their own timers.
+   * @return The current power state.
+   */
+  PowerState powerState() const;
+
+  //! @see PowerPolicy
+  const PowerPolicy &powerPolicy() const;
+
+  //! @see PowerPolicy
+  void setPowerPolicy( const PowerPolicy &value );
+
+  //! @see ResolutionPolicy
+  const ResolutionPolicy &resolutionPolicy() const;
+
+  //! @see ResolutionPolicy
+  void setResolutionPolicy( const ResolutionPolicy &value );
+
+signals:
+
+  //! Emitted when the power state changed, e.g., because rviz lost the focus or was minimized.
+  void powerStateChanged( hector_rviz_overlay::OverlayManager::PowerState state );
+
 private slots:
 
   void onZIndexChanged();
 
+  //! Re-keys the name index of the overlay that was renamed.
+  void onOverlayNameChanged( const std::string &old_name );
+
   /*!
    * This slot removes the event filter and frees the rendering resources otherwise it would crash on exit because the
    * event filter receives events after the render panel is already destroyed and the renderer may hold a pointer to
@@ -146,6 +292,12 @@ private slots:
    */
   void onAboutToQuit();
 
+  //! Re-evaluates the power state and applies the power policy if it changed.
+  void updatePowerState();
+
+  //! Destroys the renderer if there are still no overlays after the idle teardown timeout.
+  void onIdleTeardownTimeout();
+
 private:
   OverlayManager();
 
@@ -153,8 +305,27 @@ private:
 
   void checkEmpty();
 
+  //! Releases the resources of the renderer and destroys it.
+  void destroyRenderer();
+
+  /*!
+   * Erases the suffix counters of the base names the given name was generated from if no overlay
+   * with that base name or a name generated from it is left.
+   * @param name The name that was removed or renamed.
+   */
+  void pruneNameSuffixes( const std::string &name );
+
   void insertOverlay( UiOverlayPtr overlay );
 
+  //! Sorts the UI overlays by z-index and passes the new order to the renderer.
+  void applyOrder();
+
+  //! Passes the limits of the power policy for the current power state to the renderer.
+  void applyPowerPolicy();
+
+  //! Passes the resolution policy to the renderer.
+  void applyResolutionPolicy();
+
   bool eventFilter( QObject *receiver, QEvent *event ) final;
 
   bool handleMouseEvent( QObject *receiver, QMouseEvent *event );
@@ -163,11 +334,28 @@ private:
 
   bool handleKeyEvent( QObject *receiver, QKeyEvent *event );
 
+  //! Sets the overlay that receives key events and sends FocusOut and FocusIn events if it changed.
+  void setFocusedOverlay( const OverlayPtr &overlay );
+
   rviz_common::DisplayContext *context_;
-  rviz_common::RenderPanel *render_panel_;
+  QWidget *render_panel_;
+  RendererFactory renderer_factory_;
   std::vector<UiOverlayPtr> ui_overlays_;
   std::vector<PopupOverlayPtr> popup_overlays_;
+  std::unordered_map<std::string, OverlayPtr> overlays_by_name_;
+  //! The next suffix to try when generating a unique name for a given name.
+  std::unordered_map<std::string, int> next_name_suffix_;
   OverlayRenderer *renderer_;
+  int transaction_depth_ = 0;
+  bool order_outdated_ = false;
+  double frame_time_budget_ms_ = 0;
+  bool warm_up_enabled_ = false;
+  QTimer idle_teardown_timer_;
+  std::unique_ptr<InputRecorder> input_recorder_;
+  QPointer<QWindow> main_window_;
+  PowerState power_state_ = PowerActive;
+  PowerPolicy power_policy_;
+  ResolutionPolicy resolution_policy_;
 
   /*!
    * Stores the overlay that handled a mouse event (not down) previously, so that we can send events canceled if an
@@ -20,6 +20,8 @@
 
 #include <QWidget>
 
+class QPainter;
+
 namespace hector_rviz_overlay
 {
 
@@ -33,6 +35,25 @@ class OverlayWidget : public QWidget
   Q_OBJECT
 public:
   OverlayWidget();
+
+  /*!
+   * Renders the content of this widget using the given painter like QWidget::render but skips the
+   * transparent area of this widget. Only the visible children are rendered, each clipped to its
+   * own geometry. Plain QWidgets that are used as transparent containers, e.g., for layouts, are
+   * descended into instead of being rendered as a whole.
+   * If the widget paints a background itself (see paintsBackground()), the whole widget is rendered.
+   *
+   * @param painter The painter that is used to render the content. Has to be active.
+   */
+  void renderContent( QPainter *painter );
+
+protected:
+  /*!
+   * Used by renderContent() to determine whether the whole widget has to be rendered.
+   * Subclasses that paint in their paintEvent have to override this method.
+   * @return True if this widget paints anything itself, e.g., an auto filled background.
+   */
+  virtual bool paintsBackground() const;
 };
 } // namespace hector_rviz_overlay
 
@@ -19,6 +19,7 @@
 #define HECTOR_RVIZ_OVERLAY_PATH_HELPER_H
 
 #include <QString>
+#include <QUrl>
 
 namespace hector_rviz_overlay
 {
@@ -38,6 +39,19 @@ std::string resolvePath( const std::string &path );
  * @return The absolute path as described above.
  */
 QString resolvePath( const QString &path );
+
+/*!
+ * Resolves the given path of a QML file to an URL that can be loaded by a QQmlEngine.
+ * If the path starts with package://{package-name}/ and the file was compiled into the package's
+ * library as cached resource using hector_rviz_overlay_add_qml_resources (see
+ * hector_rviz_overlay-extras.cmake), the URL of the resource is returned, i.e.,
+ * qrc:/packages/{package-name}/{path}. Otherwise, the path is resolved using resolvePath.
+ * @param path The path of the QML file.
+ * @param prefer_files If true, resources are only used if the file doesn't exist in the package's
+ *   share directory, e.g., to be able to live reload the installed file during development.
+ * @return The URL of the QML file.
+ */
+QUrl resolveQmlUrl( const QString &path, bool prefer_files = false );
 } // namespace hector_rviz_overlay
 
 #endif // HECTOR_RVIZ_OVERLAY_PATH_HELPER_H
@@ -24,6 +24,7 @@
 #include "hector_rviz_overlay/popup/positioning/point_tracker.hpp"
 
 #include <QPoint>
+#include <QSize>
 
 #include <memory>
 
@@ -125,9 +126,18 @@ public:
    */
   void trackPoint( std::shared_ptr<PointTracker> tracker );
 
+  /*!
+   * Moves the popup to the position given by the PointTracker according to the anchorPoint.
+   * If the tracker supports revisions, it is only queried if its revision, the size of this
+   * container or the size of the popup changed since the last update.
+   */
+  void updatePopupPosition();
+
 protected:
   void paintEvent( QPaintEvent *event ) override;
 
+  bool paintsBackground() const override;
+
   bool event( QEvent *event ) override;
 
   QWidget *popup_;
@@ -137,6 +147,10 @@ protected:
   AnchorPoint anchor_point_;
   std::shared_ptr<PointTracker> tracker_;
   QPoint last_position_;
+  uint64_t last_tracker_revision_ = 0;
+  QSize last_container_size_;
+  QSize last_popup_size_;
+  bool position_outdated_ = true;
 };
 } // namespace hector_rviz_overlay
 
@@ -30,6 +30,10 @@ class DisplayContext;
 namespace hector_rviz_overlay
 {
 
+/*!
+ * Tracks a 3D point in the Ogre scene using the camera state provided by the
+ * positioning::CameraSnapshotService.
+ */
 class OgreTracker : public PointTracker
 {
 public:
@@ -37,6 +41,10 @@ public:
 
   QPoint getPoint( int width, int height ) override;
 
+  bool supportsRevision() const override;
+
+  uint64_t revision() override;
+
 protected:
   Ogre::Vector3 point_;
   const rviz_common::DisplayContext *context_;
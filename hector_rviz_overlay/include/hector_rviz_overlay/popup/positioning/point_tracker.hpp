@@ -20,6 +20,8 @@
 
 #include <QPoint>
 
+#include <cstdint>
+
 namespace hector_rviz_overlay
 {
 
@@ -37,6 +39,20 @@ public:
    * @return The position of the currently tracked point within the window.
    */
   virtual QPoint getPoint( int width, int height ) = 0;
+
+  /*!
+   * Whether the tracker implements revision(). Otherwise, the point is queried on every update.
+   * Default: false
+   */
+  virtual bool supportsRevision() const { return false; }
+
+  /*!
+   * Used to avoid querying the point if nothing changed. Only used if supportsRevision() is true.
+   * The point returned by getPoint may only change for the same width and height if the revision
+   * changed.
+   * @return A number that changes whenever the tracked point may have moved.
+   */
+  virtual uint64_t revision() { return 0; }
 };
 } // namespace hector_rviz_overlay
 
@@ -42,6 +42,9 @@ public:
 
   ~QWidgetPopupOverlay() override;
 
+  ///@inherit
+  void update( float dt ) override;
+
   ///@inherit
   void prepareRender( Renderer * ) override { }
 
@@ -86,6 +89,8 @@ public:
 
   bool isDirty() const override;
 
+  bool supportsResolutionScale() const override { return true; }
+
 protected:
   ///@inherit
   void renderImpl( Renderer *renderer ) override;
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_CAMERA_SNAPSHOT_SERVICE_H
+#define HECTOR_RVIZ_OVERLAY_CAMERA_SNAPSHOT_SERVICE_H
+
+#include <QObject>
+
+#include <OgreMatrix4.h>
+
+#include <cstdint>
+#include <memory>
+
+namespace Ogre
+{
+class Camera;
+}
+
+namespace rviz_common
+{
+class DisplayContext;
+}
+
+namespace hector_rviz_overlay
+{
+namespace positioning
+{
+
+/*!
+ * The state of the current view's camera at a given frame.
+ */
+struct CameraSnapshot {
+  Ogre::Matrix4 view = Ogre::Matrix4::IDENTITY;
+  Ogre::Matrix4 projection = Ogre::Matrix4::IDENTITY;
+  //! Precomputed projection * view
+  Ogre::Matrix4 view_projection = Ogre::Matrix4::IDENTITY;
+  int viewport_width = 0;
+  int viewport_height = 0;
+  //! The Ogre frame number at which this snapshot was taken.
+  unsigned long frame_id = 0;
+  //! Incremented only if any of the matrices or the viewport size changed.
+  uint64_t revision = 0;
+  //! False if there is no camera, in which case all other values are meaningless.
+  bool valid = false;
+};
+
+/*!
+ * @class CameraSnapshotService
+ * @brief Provides the current view's camera matrices and viewport size once per rendered frame.
+ *
+ * Trackers that project 3D points to the screen should read from this service instead of querying
+ * the camera themselves. The snapshot is refreshed lazily on the first call to snapshot() in a frame
+ * and always before the scene is rendered, so that it matches the rendered frame.
+ * The revision of the snapshot can be used to skip work if the camera did not change.
+ */
+class CameraSnapshotService : public QObject
+{
+  Q_OBJECT
+public:
+  CameraSnapshotService( CameraSnapshotService const & ) = delete;
+
+  void operator=( CameraSnapshotService const & ) = delete;
+
+  static CameraSnapshotService &getSingleton();
+
+  /*!
+   * Sets the display context that is used to obtain the camera of the current view.
+   * Only the first context is used, subsequent calls have no effect.
+   */
+  void attach( const rviz_common::DisplayContext *context );
+
+  /*!
+   * @return The snapshot for the current frame. Updated if it was not yet updated this frame.
+   */
+  const CameraSnapshot &snapshot();
+
+  /*!
+   * @return The camera of the current view or nullptr if there is none.
+   */
+  Ogre::Camera *camera() const;
+
+signals:
+
+  /*!
+   * Emitted before the scene is rendered in each frame after the snapshot was refreshed.
+   */
+  void frameStarted();
+
+  /*!
+   * Emitted before the scene is rendered if the snapshot's revision changed since the last frame.
+   */
+  void snapshotChanged();
+
+  /*!
+   * Emitted when the camera of the current view changed.
+   * @param camera The new camera, may be nullptr.
+   */
+  void cameraChanged( Ogre::Camera *camera );
+
+private slots:
+
+  void updateCamera();
+
+  void onAboutToQuit();
+
+private:
+  CameraSnapshotService();
+
+  ~CameraSnapshotService() override;
+
+  void refresh( bool force );
+
+  void onCameraPreRenderScene();
+
+  void onCameraDestroyed();
+
+  class Listener;
+
+  std::unique_ptr<Listener> listener_;
+  const rviz_common::DisplayContext *context_ = nullptr;
+  Ogre::Camera *camera_ = nullptr;
+  CameraSnapshot snapshot_;
+  uint64_t last_signaled_revision_ = 0;
+};
+} // namespace positioning
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_CAMERA_SNAPSHOT_SERVICE_H
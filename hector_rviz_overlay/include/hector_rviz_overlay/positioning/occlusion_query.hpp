@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_OCCLUSION_QUERY_H
+#define HECTOR_RVIZ_OVERLAY_OCCLUSION_QUERY_H
+
+#include <QObject>
+
+#include <OgreVector.h>
+
+#include <memory>
+#include <vector>
+
+namespace Ogre
+{
+class Camera;
+}
+
+namespace hector_rviz_overlay
+{
+namespace positioning
+{
+
+/*!
+ * @class OcclusionQuery
+ * @brief Determines once per frame which tracked 3D points are hidden behind scene geometry.
+ *
+ * After the scene was rendered, all registered targets are projected and the depth buffer of the
+ * render window is sampled at their screen positions in a single batch. A target is occluded if
+ * the scene depth at its position is closer to the camera than the target itself (minus the
+ * depthTolerance()).
+ * The depth is read back asynchronously into a pixel buffer and evaluated in a later frame, once
+ * the GPU finished copying it, hence, the occlusion state lags a frame behind. A multisampled
+ * depth buffer is resolved on the GPU first.
+ * Targets that are outside the view or behind the camera are reported as not occluded.
+ * The camera is obtained from the CameraSnapshotService which has to be attached to a display
+ * context.
+ */
+class OcclusionQuery : public QObject
+{
+  Q_OBJECT
+public:
+  /*!
+   * Interface for objects that want to be notified about the occlusion state of a 3D point.
+   */
+  class Target
+  {
+  public:
+    virtual ~Target() = default;
+
+    //! @return The point in the Ogre world frame that should be tested for occlusion.
+    virtual const Ogre::Vector3 &occlusionTestPoint() const = 0;
+
+    /*!
+     * Called after each query in which the occlusion state of this target changed.
+     * @param occluded Whether the point is hidden behind scene geometry.
+     */
+    virtual void setOccluded( bool occluded ) = 0;
+  };
+
+  OcclusionQuery( OcclusionQuery const & ) = delete;
+
+  void operator=( OcclusionQuery const & ) = delete;
+
+  static OcclusionQuery &getSingleton();
+
+  /*!
+   * Registers a target that is tested for occlusion in each frame. The target has to be removed
+   * using removeTarget before it is destroyed.
+   * @param target The target that is tested.
+   */
+  void addTarget( Target *target );
+
+  void removeTarget( Target *target );
+
+  /*!
+   * The distance (in meters along the view direction) by which scene geometry has to be in front
+   * of a target before the target is considered occluded. Default: 0.05
+   */
+  float depthTolerance() const;
+
+  void setDepthTolerance( float value );
+
+private slots:
+
+  void updateCamera( Ogre::Camera *camera );
+
+  void onAboutToQuit();
+
+private:
+  OcclusionQuery();
+
+  ~OcclusionQuery() override;
+
+  void runQuery( Ogre::Camera *camera );
+
+  //! Evaluates the read-backs of previous frames that the GPU has finished.
+  void consumeReadBacks( Ogre::Camera *camera );
+
+  //! Starts the asynchronous read-back of the depth at the positions of the current samples_.
+  void startReadBack( Ogre::Camera *camera, const Ogre::Matrix4 &projection );
+
+  /*!
+   * Creates or resizes the framebuffer that a multisampled depth buffer is resolved into.
+   * @param source_framebuffer The framebuffer the scene was rendered to. Its depth format is used.
+   * @return False if the depth format of the source framebuffer is not supported.
+   */
+  bool prepareResolveFramebuffer( int width, int height, unsigned source_framebuffer );
+
+  //! Deletes the GL objects. Requires the render window's context to be current.
+  void releaseReadBacks();
+
+  class Listener;
+
+  struct ReadBack;
+
+  struct Sample {
+    Target *target;
+    int x;
+    int y;
+    float distance;
+    //! The index of the depth value of this sample in the read-back buffer.
+    size_t offset;
+  };
+
+  std::unique_ptr<Listener> listener_;
+  Ogre::Camera *camera_ = nullptr;
+  std::vector<Target *> targets_;
+  std::vector<bool> occluded_;
+  std::vector<Sample> samples_;
+  std::vector<ReadBack> read_backs_;
+  std::vector<float> depth_buffer_;
+  unsigned frame_ = 0;
+  //! Framebuffer and depth renderbuffer used to resolve a multisampled depth buffer.
+  unsigned resolve_framebuffer_ = 0;
+  unsigned resolve_depth_buffer_ = 0;
+  int resolve_width_ = 0;
+  int resolve_height_ = 0;
+  //! Set if the GL functions could not be loaded or the depth buffer can not be read.
+  bool unsupported_ = false;
+  float depth_tolerance_ = 0.05f;
+};
+} // namespace positioning
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_OCCLUSION_QUERY_H
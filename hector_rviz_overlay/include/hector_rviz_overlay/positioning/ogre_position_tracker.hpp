@@ -18,14 +18,12 @@
 #ifndef HECTOR_RVIZ_OVERLAY_OGRE_POSITION_TRACKER_H
 #define HECTOR_RVIZ_OVERLAY_OGRE_POSITION_TRACKER_H
 
+#include "hector_rviz_overlay/positioning/occlusion_query.hpp"
 #include "hector_rviz_overlay/positioning/position_tracker.hpp"
 
 #include <Ogre.h>
 
-namespace Ogre
-{
-class Camera;
-}
+#include <cstdint>
 
 namespace rviz_common
 {
@@ -45,8 +43,11 @@ namespace positioning
  * Returns x and y position in viewport coordinates (pixel).
  * Returns the distance as z-coordinate unless it is not available, e.g., for a orthographic
  * projection, in which case z is set to NaN.
+ * The camera state is obtained from the CameraSnapshotService and the position is only recomputed if
+ * the snapshot or the overlay's scale changed.
+ * The occluded property is updated using the OcclusionQuery after the scene was rendered.
  */
-class OgrePositionTracker : public PositionTracker
+class OgrePositionTracker : public PositionTracker, private OcclusionQuery::Target
 {
   Q_OBJECT
 public:
@@ -56,18 +57,17 @@ public:
   ~OgrePositionTracker() override;
 
 private:
-  void checkPosition();
+  const Ogre::Vector3 &occlusionTestPoint() const override;
 
-  void updateCamera();
+  void setOccluded( bool occluded ) override;
+
+  void checkPosition();
 
   Ogre::Vector3 point_;
   const rviz_common::DisplayContext *context_;
   const Overlay *overlay_;
-  Ogre::Camera *camera_ = nullptr;
-
-  class Listener;
-
-  std::unique_ptr<Listener> listener_;
+  uint64_t last_revision_ = 0;
+  float last_scale_ = 0;
 };
 } // namespace positioning
 } // namespace hector_rviz_overlay
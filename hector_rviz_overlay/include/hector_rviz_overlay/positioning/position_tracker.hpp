@@ -49,19 +49,29 @@ class PositionTracker : public QObject
   //! The position of the tracked point on the screen. May have a z-component indicating the depth.
   //! If no depth is available, z will be NaN.
   Q_PROPERTY( QVector3D position READ position NOTIFY positionChanged )
+  //! Whether the tracked point is hidden behind scene geometry. Always false if the tracker does
+  //! not support occlusion testing.
+  Q_PROPERTY( bool occluded READ occluded NOTIFY occludedChanged )
   // @formatter:on
 public:
   const QVector3D &position() const;
 
+  bool occluded() const;
+
 signals:
 
   void positionChanged( const QVector3D &position );
 
+  void occludedChanged( bool occluded );
+
 protected:
   void updatePosition( const QVector3D &position );
 
+  void updateOccluded( bool occluded );
+
 private:
   QVector3D position_;
+  bool occluded_ = false;
 };
 } // namespace positioning
 } // namespace hector_rviz_overlay
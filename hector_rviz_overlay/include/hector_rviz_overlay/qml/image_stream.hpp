@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_IMAGE_STREAM_H
+#define HECTOR_RVIZ_OVERLAY_IMAGE_STREAM_H
+
+#include <QSize>
+#include <QString>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class QObject;
+
+namespace hector_rviz_overlay
+{
+
+struct ImageStreamFrame {
+  enum Format { Rgba8, Bgra8, Rgb8, Bgr8, Mono8 };
+
+  //! The tightly packed pixel data, i.e., the stride is width * bytesPerPixel( format ).
+  std::vector<unsigned char> data;
+  int width = 0;
+  int height = 0;
+  Format format = Rgba8;
+  //! Incremented for each published frame. 0 means the frame was never published.
+  uint64_t sequence = 0;
+
+  static int bytesPerPixel( Format format );
+};
+
+/*!
+ * @class ImageStream
+ * @brief Passes image frames, e.g., from a camera topic, from any thread to ImageStream QML items.
+ *
+ * Streams are identified by name and shared with the items showing them using get().
+ * The frames are triple buffered: The producer writes into the back frame while the render thread
+ * uploads the front frame and the third frame holds the latest published frame. Frames that are
+ * published before the previous one was picked up replace it and are never uploaded. The buffers
+ * are reused, hence, publishing does not allocate unless the size of the images increases.
+ */
+class ImageStream
+{
+public:
+  /*!
+   * @class FrameWriter
+   * @brief Provides the buffer of the next frame and publishes it on destruction.
+   *
+   * Only one frame can be written at a time. Other threads calling beginFrame() block until the
+   * current frame is published.
+   */
+  class FrameWriter
+  {
+  public:
+    FrameWriter( FrameWriter &&other ) noexcept;
+
+    FrameWriter( const FrameWriter & ) = delete;
+
+    FrameWriter &operator=( const FrameWriter & ) = delete;
+
+    FrameWriter &operator=( FrameWriter && ) = delete;
+
+    //! Publishes the frame.
+    ~FrameWriter();
+
+    //! @return The tightly packed pixel data of the frame. The content is undefined.
+    unsigned char *data() { return frame_->data.data(); }
+
+    //! @return The size of a row in bytes.
+    int stride() const { return frame_->width * ImageStreamFrame::bytesPerPixel( frame_->format ); }
+
+  private:
+    friend class ImageStream;
+
+    FrameWriter( ImageStream *stream, std::unique_lock<std::mutex> lock, ImageStreamFrame *frame );
+
+    ImageStream *stream_;
+    std::unique_lock<std::mutex> lock_;
+    ImageStreamFrame *frame_;
+  };
+
+  /*!
+   * Thread-safe.
+   * @param name The name of the stream, e.g., the topic of the camera.
+   * @return The stream with the given name. Created if it does not exist yet. The stream is
+   *   destroyed once the last pointer to it is released.
+   */
+  static std::shared_ptr<ImageStream> get( const QString &name );
+
+  /*!
+   * Starts writing the next frame. Allows to, e.g., convert or decode an image directly into the
+   * buffer of the frame. Thread-safe.
+   */
+  FrameWriter beginFrame( int width, int height, ImageStreamFrame::Format format );
+
+  /*!
+   * Copies the image into the next frame and publishes it. Thread-safe.
+   * @param stride The size of a row of the source in bytes.
+   */
+  void publish( const void *data, int width, int height, int stride,
+                ImageStreamFrame::Format format );
+
+  //! The size of the latest published frame. Thread-safe.
+  QSize size() const;
+
+  /*!
+   * Picks up the latest published frame if there is a new one.
+   * Must only be called on the render thread.
+   * @return The latest frame that was published or nullptr if no frame was published yet.
+   */
+  const ImageStreamFrame *acquireLatest();
+
+  /*!
+   * Registers an object that is notified using a queued invocation of its onFrameAvailable slot
+   * when a new frame is published. Thread-safe.
+   */
+  void addListener( QObject *listener );
+
+  //! Thread-safe.
+  void removeListener( QObject *listener );
+
+private:
+  ImageStream() = default;
+
+  void publish();
+
+  static constexpr int IndexMask = 3;
+  static constexpr int NewFrameFlag = 4;
+
+  ImageStreamFrame frames_[3];
+  std::mutex producer_mutex_;
+  //! Guarded by producer_mutex_.
+  int back_index_ = 0;
+  uint64_t sequence_ = 0;
+  std::atomic<int> shared_index_{ 1 };
+  //! Only accessed by the render thread.
+  int front_index_ = 2;
+  std::atomic<int> width_{ 0 };
+  std::atomic<int> height_{ 0 };
+  //! Set when a frame is published until the listeners were notified and the frame was acquired.
+  std::atomic<bool> notification_pending_{ false };
+  std::mutex listener_mutex_;
+  std::vector<QObject *> listeners_;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_IMAGE_STREAM_H
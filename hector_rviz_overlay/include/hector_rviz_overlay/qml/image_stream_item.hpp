@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_IMAGE_STREAM_ITEM_H
+#define HECTOR_RVIZ_OVERLAY_IMAGE_STREAM_ITEM_H
+
+#include <QQuickItem>
+
+#include <memory>
+
+namespace hector_rviz_overlay
+{
+
+class ImageStream;
+class ImageStreamTextureProvider;
+
+/*!
+ * @class ImageStreamItem
+ * @brief A QML item showing the latest frame of an ImageStream, e.g., a camera feed.
+ *
+ * Available in QML as ImageStream from the Hector.RvizOverlay 1.0 module.
+ * New frames are uploaded into a persistent texture using a pixel buffer object if available.
+ * Frames that are published while the previous one was not uploaded yet are dropped.
+ * The item is a texture provider, hence, it can be used as source of a ShaderEffect.
+ *
+ * Example:
+ * @code
+ * import Hector.RvizOverlay 1.0
+ * ImageStream {
+ *   width: 480; height: 270
+ *   stream: "/camera/image_raw"
+ *   fillMode: ImageStream.PreserveAspectFit
+ * }
+ * @endcode
+ */
+class ImageStreamItem : public QQuickItem
+{
+  Q_OBJECT
+  // @formatter:off
+  Q_PROPERTY( QString stream READ stream WRITE setStream NOTIFY streamChanged )
+  Q_PROPERTY( FillMode fillMode READ fillMode WRITE setFillMode NOTIFY fillModeChanged )
+  Q_PROPERTY( QSize sourceSize READ sourceSize NOTIFY sourceSizeChanged )
+  // @formatter:on
+public:
+  enum FillMode { Stretch, PreserveAspectFit, PreserveAspectCrop };
+  Q_ENUM( FillMode )
+
+  explicit ImageStreamItem( QQuickItem *parent = nullptr );
+
+  ~ImageStreamItem() override;
+
+  //! The name of the ImageStream that is shown. @see ImageStream::get
+  const QString &stream() const { return stream_name_; }
+
+  void setStream( const QString &value );
+
+  //! Default: PreserveAspectFit
+  FillMode fillMode() const { return fill_mode_; }
+
+  void setFillMode( FillMode value );
+
+  //! The size of the latest frame of the stream.
+  QSize sourceSize() const { return source_size_; }
+
+  bool isTextureProvider() const override { return true; }
+
+  QSGTextureProvider *textureProvider() const override;
+
+signals:
+
+  void streamChanged();
+
+  void fillModeChanged();
+
+  void sourceSizeChanged();
+
+protected:
+  QSGNode *updatePaintNode( QSGNode *old_node, UpdatePaintNodeData * ) override;
+
+  void itemChange( ItemChange change, const ItemChangeData &value ) override;
+
+  void releaseResources() override;
+
+private slots:
+
+  void onFrameAvailable();
+
+  void invalidateSceneGraph();
+
+private:
+  QString stream_name_;
+  std::shared_ptr<ImageStream> stream_;
+  FillMode fill_mode_ = PreserveAspectFit;
+  QSize source_size_;
+  //! Created and used on the render thread.
+  mutable ImageStreamTextureProvider *provider_ = nullptr;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_IMAGE_STREAM_ITEM_H
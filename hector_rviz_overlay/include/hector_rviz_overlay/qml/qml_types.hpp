@@ -0,0 +1,32 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_QML_TYPES_H
+#define HECTOR_RVIZ_OVERLAY_QML_TYPES_H
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * Registers the QML types provided by hector_rviz_overlay in the Hector.RvizOverlay 1.0 module.
+ * Called by QmlOverlay before the first QML file is loaded.
+ * Calling it more than once has no effect.
+ */
+void registerQmlTypes();
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_QML_TYPES_H
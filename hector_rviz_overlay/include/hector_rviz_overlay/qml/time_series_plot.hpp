@@ -0,0 +1,249 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_TIME_SERIES_PLOT_H
+#define HECTOR_RVIZ_OVERLAY_TIME_SERIES_PLOT_H
+
+#include "hector_rviz_overlay/helper/mpsc_queue.hpp"
+
+#include <QColor>
+#include <QQuickItem>
+
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace hector_rviz_overlay
+{
+
+class TimeSeriesPlot;
+
+struct TimeSeriesSample {
+  double time = 0;
+  double value = 0;
+};
+
+/*!
+ * @class TimeSeriesChannel
+ * @brief A thread-safe handle to feed samples into a channel of a TimeSeriesPlot.
+ *
+ * The handle can outlive the plot in which case appended samples are discarded.
+ */
+class TimeSeriesChannel
+{
+public:
+  /*!
+   * Appends a sample. Thread-safe and lock-free except for the first sample after each frame
+   * which notifies the plot.
+   * The timestamps of the samples of a channel should be monotonically increasing. Samples that
+   * are older than the last sample are drawn at the time of the last sample.
+   *
+   * @param time The timestamp of the sample in seconds. The epoch is arbitrary but has to be the
+   *   same for all channels of a plot.
+   * @param value The value of the sample.
+   * @return False if the queue is full (see QueueCapacity), e.g., because the plot is currently not
+   *   rendered, and the sample was dropped.
+   */
+  bool append( double time, double value );
+
+  //! The maximum number of samples that can be appended between two frames.
+  static constexpr size_t QueueCapacity = 8192;
+
+private:
+  friend class TimeSeriesPlot;
+
+  explicit TimeSeriesChannel( TimeSeriesPlot *plot );
+
+  MpscQueue<TimeSeriesSample> queue_;
+  std::atomic<bool> update_pending_{ false };
+  std::mutex plot_mutex_;
+  TimeSeriesPlot *plot_;
+};
+
+/*!
+ * @class TimeSeriesPlot
+ * @brief A native QML item plotting one or more channels of samples over time.
+ *
+ * Available in QML as TimeSeriesPlot from the Hector.RvizOverlay 1.0 module.
+ * Samples are fed from C++ using a TimeSeriesChannel obtained with channel() which can be used
+ * from any thread, or from QML using append(). They are kept in a fixed-capacity ring buffer per
+ * channel and decimated to the pixel resolution of the plot, either incrementally using the
+ * minimum and maximum per pixel column (default) or using the largest triangle three buckets
+ * algorithm (LTTB).
+ * The decimated vertices are in data coordinates and mapped to the item using a transform node,
+ * hence, in MinMax mode only the vertices of new pixel columns are computed while scrolling and
+ * the JS engine is never involved.
+ *
+ * Example:
+ * @code
+ * import Hector.RvizOverlay 1.0
+ * TimeSeriesPlot {
+ *   width: 300; height: 100
+ *   timeWindow: 10
+ *   Component.onCompleted: addChannel("velocity", "orange")
+ * }
+ * @endcode
+ */
+class TimeSeriesPlot : public QQuickItem
+{
+  Q_OBJECT
+  // @formatter:off
+  Q_PROPERTY( double timeWindow READ timeWindow WRITE setTimeWindow NOTIFY timeWindowChanged )
+  Q_PROPERTY( bool autoScale READ autoScale WRITE setAutoScale NOTIFY autoScaleChanged )
+  Q_PROPERTY( double minimum READ minimum WRITE setMinimum NOTIFY minimumChanged )
+  Q_PROPERTY( double maximum READ maximum WRITE setMaximum NOTIFY maximumChanged )
+  Q_PROPERTY( double displayedMinimum READ displayedMinimum NOTIFY displayedRangeChanged )
+  Q_PROPERTY( double displayedMaximum READ displayedMaximum NOTIFY displayedRangeChanged )
+  Q_PROPERTY( int capacity READ capacity WRITE setCapacity NOTIFY capacityChanged )
+  Q_PROPERTY( Decimation decimation READ decimation WRITE setDecimation NOTIFY decimationChanged )
+  Q_PROPERTY( int channelCount READ channelCount NOTIFY channelCountChanged )
+  // @formatter:on
+public:
+  enum Decimation {
+    //! The first extremum and the second extremum of each pixel column in the order they occurred.
+    MinMax,
+    //! Largest triangle three buckets. Recomputed for the whole time window on each new sample.
+    Lttb
+  };
+  Q_ENUM( Decimation )
+
+  explicit TimeSeriesPlot( QQuickItem *parent = nullptr );
+
+  ~TimeSeriesPlot() override;
+
+  //! The duration in seconds that is shown. Default: 10
+  double timeWindow() const { return time_window_; }
+
+  void setTimeWindow( double value );
+
+  //! If true (default), the value range is fitted to the visible samples.
+  bool autoScale() const { return auto_scale_; }
+
+  void setAutoScale( bool value );
+
+  //! The lower end of the value range if autoScale is false.
+  double minimum() const { return minimum_; }
+
+  void setMinimum( double value );
+
+  //! The upper end of the value range if autoScale is false.
+  double maximum() const { return maximum_; }
+
+  void setMaximum( double value );
+
+  //! The lower end of the value range that is currently shown, e.g., for axis labels.
+  double displayedMinimum() const { return displayed_minimum_; }
+
+  //! The upper end of the value range that is currently shown, e.g., for axis labels.
+  double displayedMaximum() const { return displayed_maximum_; }
+
+  //! The number of samples that are kept per channel. Default: 10000
+  int capacity() const { return capacity_; }
+
+  void setCapacity( int value );
+
+  Decimation decimation() const { return decimation_; }
+
+  void setDecimation( Decimation value );
+
+  int channelCount() const { return static_cast<int>( channels_.size() ); }
+
+  /*!
+   * Adds a channel that is drawn as a line.
+   * @return The index of the new channel.
+   */
+  Q_INVOKABLE int addChannel( const QString &name, const QColor &color, qreal line_width = 1 );
+
+  //! Appends a sample to the channel with the given index. @see TimeSeriesChannel::append
+  Q_INVOKABLE void append( int channel, double time, double value );
+
+  //! Removes the samples of all channels.
+  Q_INVOKABLE void clear();
+
+  ///@{
+  //! @return A handle to feed samples from any thread or nullptr if there is no such channel.
+  std::shared_ptr<TimeSeriesChannel> channel( int index ) const;
+
+  std::shared_ptr<TimeSeriesChannel> channel( const QString &name ) const;
+  ///@}
+
+signals:
+
+  void timeWindowChanged();
+
+  void autoScaleChanged();
+
+  void minimumChanged();
+
+  void maximumChanged();
+
+  void displayedRangeChanged();
+
+  void capacityChanged();
+
+  void decimationChanged();
+
+  void channelCountChanged();
+
+protected:
+  void updatePolish() override;
+
+  QSGNode *updatePaintNode( QSGNode *old_node, UpdatePaintNodeData * ) override;
+
+  void geometryChanged( const QRectF &new_geometry, const QRectF &old_geometry ) override;
+
+private slots:
+
+  void onSamplesAvailable();
+
+private:
+  struct ChannelData;
+
+  void requestRebuild();
+
+  void rebuild();
+
+  void appendToMinMax( ChannelData &channel, const TimeSeriesSample &sample );
+
+  void compact( ChannelData &channel, int64_t latest_bucket );
+
+  void computeLttb( ChannelData &channel );
+
+  void updateVisibleRange();
+
+  size_t vertexBudget() const { return 4 * static_cast<size_t>( bucket_count_ ) + 16; }
+
+  std::vector<std::unique_ptr<ChannelData>> channels_;
+  double time_window_ = 10;
+  bool auto_scale_ = true;
+  double minimum_ = 0;
+  double maximum_ = 1;
+  double displayed_minimum_ = 0;
+  double displayed_maximum_ = 1;
+  int capacity_ = 10000;
+  Decimation decimation_ = MinMax;
+
+  // Derived from the width and the time window. A bucket is one pixel column.
+  int bucket_count_ = 1;
+  double bucket_duration_ = 10;
+  double latest_time_ = -std::numeric_limits<double>::infinity();
+  bool rebuild_required_ = true;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_TIME_SERIES_PLOT_H
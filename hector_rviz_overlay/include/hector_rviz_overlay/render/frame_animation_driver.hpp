@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_FRAME_ANIMATION_DRIVER_H
+#define HECTOR_RVIZ_OVERLAY_FRAME_ANIMATION_DRIVER_H
+
+#include <QAnimationDriver>
+#include <QElapsedTimer>
+#include <QTimer>
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class FrameAnimationDriver
+ * @brief An animation driver that advances Qt animations once per rendered overlay frame.
+ *
+ * Instead of ticking with a wall-clock timer, animations are advanced by the OverlayRenderer using
+ * the time elapsed since the last frame. Hence, animations produce exactly one step per frame and
+ * don't wake the event loop in between.
+ *
+ * The driver is installed while it is acquired by at least one user, e.g., a QmlOverlay with
+ * render resources. Note that the animation driver is shared by all animations on the GUI thread,
+ * i.e., animations in rviz's own UI are affected as well.
+ */
+class FrameAnimationDriver : public QAnimationDriver
+{
+  Q_OBJECT
+public:
+  enum Mode {
+    //! The driver is not installed and Qt's default wall-clock driver is used.
+    WallClock,
+    //! Animations are advanced once per frame. If no frames are rendered, e.g., because no overlay
+    //! is visible, animations fall back to advancing with the wall-clock.
+    FrameSynced,
+    //! Like FrameSynced but without a fallback. Animations pause while no frames are rendered, e.g.,
+    //! if all overlays are hidden or rviz is minimized, and continue where they left off.
+    FrameSyncedPausing
+  };
+  Q_ENUM( Mode )
+
+  //! Installs the driver if this is the first user and the mode is not WallClock.
+  static void acquire();
+
+  //! Uninstalls the driver if this was the last user.
+  static void release();
+
+  /*!
+   * Advances the animations by the given time if the driver is installed.
+   * Called by the OverlayRenderer once per frame.
+   * @param dt The time since the last frame in seconds.
+   */
+  static void advanceFrame( float dt );
+
+  //! @return The current mode. Default: FrameSynced
+  static Mode mode();
+
+  //! @see Mode
+  static void setMode( Mode value );
+
+  /*!
+   * Limits how often animations are advanced, e.g., to save power while rviz is not active.
+   * The animation time still advances with the frames, only the number of steps is reduced.
+   * @param value The maximum number of animation steps per second. 0 for unlimited (default).
+   */
+  static void setMaxTickRate( float value );
+
+  /*!
+   * While paused, animations are not advanced, not even by the wall-clock fallback, and continue
+   * where they left off when resumed.
+   * @param value Whether animations driven by this driver are paused.
+   */
+  static void setPaused( bool value );
+
+  //! @return The animation time since the driver was started in ms.
+  qint64 elapsed() const override;
+
+protected:
+  void start() override;
+
+  void stop() override;
+
+private:
+  FrameAnimationDriver();
+
+  static void updateInstallation();
+
+  //! Advances the animation time by the given time in ns but at most by the wall-clock time.
+  void advanceBy( qint64 ns );
+
+  //! Calls advance() if running and the max tick rate allows it.
+  //! @param now The wall-clock time in ns.
+  void tick( qint64 now );
+
+  //! Restarts the single-shot fallback timer with the given delay if the fallback is in use.
+  void restartFallbackTimer( int ms );
+
+  void onFallbackTimeout();
+
+  QElapsedTimer wall_clock_;
+  QTimer fallback_timer_;
+  //! All times are in ns.
+  qint64 elapsed_ns_ = 0;
+  qint64 last_tick_wall_ns_ = 0;
+  qint64 last_advance_wall_ns_ = 0;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_FRAME_ANIMATION_DRIVER_H
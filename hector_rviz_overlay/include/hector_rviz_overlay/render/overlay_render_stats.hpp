@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_OVERLAY_RENDER_STATS_H
+#define HECTOR_RVIZ_OVERLAY_OVERLAY_RENDER_STATS_H
+
+#include <cstddef>
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * Statistics on the scheduling of an overlay by the OverlayRenderer.
+ */
+struct OverlayRenderStats {
+  //! How often the overlay was rendered.
+  size_t renders = 0;
+  //! How often the overlay was dirty but its rendering was deferred to a later frame.
+  size_t deferrals = 0;
+  //! Exponential moving average of the time it took to render the overlay in ms.
+  double average_render_time_ms = 0;
+  //! The time between the overlay becoming dirty and being rendered for the last render in ms.
+  double last_latency_ms = 0;
+  //! The maximum time between the overlay becoming dirty and being rendered in ms.
+  double worst_latency_ms = 0;
+};
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_OVERLAY_RENDER_STATS_H
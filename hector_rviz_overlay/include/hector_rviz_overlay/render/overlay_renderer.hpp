@@ -19,15 +19,17 @@
 #define HECTOR_RVIZ_OVERLAY_OVERLAY_RENDERER_H
 
 #include "hector_rviz_overlay/overlay.hpp"
+#include "hector_rviz_overlay/render/overlay_render_stats.hpp"
 #include "renderer.hpp"
 
 #include <chrono>
+#include <unordered_map>
+
+class QWidget;
 
 namespace rviz_common
 {
 class DisplayContext;
-
-class RenderPanel;
 } // namespace rviz_common
 
 namespace hector_rviz_overlay
@@ -39,6 +41,11 @@ namespace hector_rviz_overlay
  *
  * This base class provides functionality to manage the rendered overlays and renders them in order
  * (first to last). See subclasses for specific rendering methods.
+ *
+ * Each overlay is rendered into its own layer and the layers are composed into the final image.
+ * This allows the renderer to stay within a frame time budget by only rendering as many dirty
+ * overlays as fit into the budget. The others keep showing the content of their layer and are
+ * rendered in later frames, ordered by their render priority and how long they have been waiting.
  */
 class OverlayRenderer : public QObject, public Renderer
 {
@@ -57,6 +64,12 @@ public:
 
   explicit OverlayRenderer( rviz_common::DisplayContext *context );
 
+  /*!
+   * Creates a renderer without rviz, e.g., for a headless test harness.
+   * @param render_panel The widget the overlays are drawn on. Its size is the size of the overlays.
+   */
+  explicit OverlayRenderer( QWidget *render_panel );
+
   ~OverlayRenderer() override;
 
   /*!
@@ -95,6 +108,13 @@ public:
    */
   void removeOverlay( hector_rviz_overlay::OverlayPtr &overlay );
 
+  /*!
+   * Replaces the render order of the overlays in a single pass.
+   * The given order has to contain exactly the overlays that were added to this renderer.
+   * @param order The overlays in the order in which they should be rendered (first to last).
+   */
+  void reorderOverlays( const std::vector<OverlayPtr> &order );
+
   const std::vector<OverlayPtr> &overlays();
 
   std::vector<OverlayConstPtr> overlays() const;
@@ -103,6 +123,118 @@ public:
 
   bool isRendering() const;
 
+  /*!
+   * The time in ms that may be spent on updating and rendering overlays per frame.
+   * If exceeded, the remaining dirty overlays are deferred to later frames. At least one dirty
+   * overlay is rendered per frame and overlays that were never rendered are always rendered.
+   * @return The frame time budget in ms. 0 means unlimited (default).
+   */
+  double frameTimeBudget() const;
+
+  /*!
+   * @see frameTimeBudget()
+   * @param value The frame time budget in ms. 0 for unlimited.
+   */
+  void setFrameTimeBudget( double value );
+
+  /*!
+   * @param overlay The overlay for which the statistics are returned.
+   * @return The render statistics of the given overlay or default values if it is not rendered by
+   *   this renderer.
+   */
+  OverlayRenderStats renderStats( const Overlay *overlay ) const;
+
+  //! Resets the render statistics of all overlays.
+  void resetRenderStats();
+
+  /*!
+   * An upper limit for the update rate of all overlays which is applied in addition to each
+   * overlay's own maxUpdateRate(), e.g., to save power while rviz is not the active window.
+   * @return The maximum number of renders per second per overlay. 0 means unlimited (default).
+   */
+  float globalMaxUpdateRate() const;
+
+  /*!
+   * @see globalMaxUpdateRate()
+   * @param value The maximum number of renders per second per overlay. 0 for unlimited.
+   */
+  void setGlobalMaxUpdateRate( float value );
+
+  /*!
+   * While suspended, overlays are neither updated nor rendered. Queued updates are still applied.
+   * @return Whether rendering is suspended, e.g., because rviz is minimized.
+   */
+  bool isSuspended() const;
+
+  //! @see isSuspended()
+  void setSuspended( bool value );
+
+  /*!
+   * If enabled, hidden overlays that were never rendered are prepared and rendered once offscreen
+   * in idle frames, i.e., frames in which no other overlay had to be rendered, shortly after the
+   * renderer was created. This compiles shaders and fills glyph caches ahead of time, so that
+   * showing the overlay later does not cause a hitch. At most one overlay is warmed up at a time
+   * with a pause in between and never while a mouse button is pressed, e.g., while the user moves
+   * the camera. Overlays with the ReleaseWhenHidden policy are not warmed up.
+   * @return Whether hidden overlays are warmed up. Default: false
+   */
+  bool warmUpEnabled() const;
+
+  //! @see warmUpEnabled()
+  void setWarmUpEnabled( bool value );
+
+  /*!
+   * Overlays that support it (see Overlay::supportsResolutionScale()) are rendered into layers with
+   * this fraction of the native resolution which are upscaled with linear filtering when the layers
+   * are composed. This reduces the cost of painting, e.g., on high dpi screens.
+   * If the adaptive render resolution is enabled, this is the upper limit.
+   * @return The render resolution in the range [MinRenderResolution, 1]. Default: 1
+   */
+  float renderResolution() const;
+
+  //! @see renderResolution()
+  void setRenderResolution( float value );
+
+  /*!
+   * If enabled, the render resolution is lowered in steps while the average time spent rendering
+   * overlays per frame exceeds the targetRenderTime() and raised again once it is below half of
+   * the target. The resolution stays within [minAdaptiveRenderResolution(), renderResolution()].
+   * @return Whether the render resolution is adapted automatically. Default: false
+   */
+  bool adaptiveRenderResolution() const;
+
+  //! @see adaptiveRenderResolution()
+  void setAdaptiveRenderResolution( bool value );
+
+  /*!
+   * @see adaptiveRenderResolution()
+   * @return The lowest render resolution the adaptive render resolution may use. Default: 0.5
+   */
+  float minAdaptiveRenderResolution() const;
+
+  //! @see minAdaptiveRenderResolution()
+  void setMinAdaptiveRenderResolution( float value );
+
+  /*!
+   * @see adaptiveRenderResolution()
+   * @return The average time in ms that may be spent rendering overlays per frame. Default: 4
+   */
+  double targetRenderTime() const;
+
+  //! @see targetRenderTime()
+  void setTargetRenderTime( double value );
+
+  /*!
+   * @return The render resolution that is currently used for overlays that support it. Differs
+   *   from renderResolution() if the adaptive render resolution lowered it.
+   */
+  float effectiveRenderResolution() const;
+
+  float resolutionScale() const noexcept override;
+
+  //! The lowest supported render resolution.
+  static constexpr float MinRenderResolution = 0.25f;
+
 protected slots:
 
   void onVisibilityChanged();
@@ -127,6 +259,12 @@ protected:
    */
   virtual void releaseOverlay( OverlayPtr &overlay );
 
+  /*!
+   * Releases the render resources of all overlays that have not already been released due to their
+   * HiddenPolicy and resets their render states. Meant to be called in releaseResources.
+   */
+  void releaseOverlays();
+
   /*!
    * Updates the geometry of the overlays and renders them using the resources provided by subclasses.
    * Also handles measuring and drawing the frame time if enabled using the compile flag.
@@ -147,12 +285,59 @@ protected:
    */
   virtual void prepareRender( int width, int height ) = 0;
 
+  /*!
+   * Called before the given overlay is rendered. The paintDevice, framebufferObject and context
+   * have to be set up such that the overlay is rendered into an empty target which is stored as the
+   * overlay's layer in endOverlayRender.
+   * @param overlay The overlay that is rendered next.
+   */
+  virtual void beginOverlayRender( const Overlay &overlay ) = 0;
+
+  /*!
+   * Called after the given overlay was rendered. Should store the rendered content as the layer of
+   * the overlay which is used in composeOverlay until the overlay is rendered again.
+   * @param overlay The overlay that was rendered.
+   */
+  virtual void endOverlayRender( const Overlay &overlay ) = 0;
+
+  /*!
+   * Called after all overlays that fit into the frame time budget were rendered. Should clear the
+   * final image before the layers are composed using composeOverlay.
+   */
+  virtual void beginComposition() = 0;
+
+  /*!
+   * Draws the layer of the given overlay on top of the final image.
+   * Only called for visible overlays with a layer from a previous call to endOverlayRender.
+   * @param overlay The overlay whose layer is drawn.
+   */
+  virtual void composeOverlay( const Overlay &overlay ) = 0;
+
+  /*!
+   * Called after the layers of all visible overlays were passed to composeOverlay. Renderers that
+   * defer the composition, e.g., to compose only the changed parts, have to finish it here.
+   */
+  virtual void endComposition() { }
+
+  /*!
+   * Releases the layer of the given overlay, e.g., because it was removed.
+   * @param overlay The overlay whose layer is released.
+   */
+  virtual void releaseOverlayLayer( const Overlay &overlay ) = 0;
+
   /*!
    * This method is called after the overlays are rendered.
    * It should handle cleaning up and making sure the content is visible.
    */
   virtual void finishRender() = 0;
 
+  /*!
+   * This method is called instead of finishRender if an overlay was rendered into its layer
+   * without composing the final image, e.g., when warming up a hidden overlay.
+   * It should clean up what was set up in prepareRender.
+   */
+  virtual void finishOffscreenRender() { }
+
   /*!
    * This method is called if all overlays are removed or invisible in which case remains of
    * previous renderings should be removed if necessary since the prepareRender and finishRender
@@ -161,7 +346,7 @@ protected:
   virtual void hide() = 0;
 
   rviz_common::DisplayContext *context_;
-  rviz_common::RenderPanel *render_panel_;
+  QWidget *render_panel_;
   std::vector<OverlayPtr> overlays_;
   QRect geometry_;
 
@@ -174,6 +359,89 @@ protected:
   bool is_dirty_ = false;
   bool no_visible_overlays_ = false;
   bool initialized_ = false;
+
+private:
+  struct OverlayState {
+    OverlayRenderStats stats;
+    std::chrono::high_resolution_clock::time_point pending_since;
+    std::chrono::high_resolution_clock::time_point last_render;
+    std::chrono::high_resolution_clock::time_point hidden_since;
+    bool pending = false;
+    bool has_layer = false;
+    bool hidden = false;
+    //! Whether the overlay was rendered at least once, either visible or in a warm-up.
+    bool rendered = false;
+    //! Whether the render resources were released due to the overlay's HiddenPolicy.
+    bool released = false;
+    //! The resolution the layer was rendered at.
+    float resolution = 1;
+    //! The render priority increased by the time the overlay has been pending.
+    int effective_priority = 0;
+  };
+
+  //! @return The resolution the layer of the given overlay should be rendered at.
+  float layerResolution( const Overlay &overlay ) const;
+
+  /*!
+   * Updates the average render time and adapts the effective render resolution if the adaptive
+   * render resolution is enabled. Only called for frames in which overlays were rendered, so that
+   * idle frames don't lower the average.
+   * @param render_time_ms The time spent rendering overlays in this frame.
+   */
+  void updateRenderResolution( const std::chrono::high_resolution_clock::time_point &now,
+                               double render_time_ms );
+
+  /*!
+   * Called for frames in which no overlay was rendered. Restores the full render resolution once
+   * nothing was rendered for a while.
+   */
+  void restoreIdleRenderResolution( const std::chrono::high_resolution_clock::time_point &now );
+
+  /*!
+   * Releases the render resources of overlays that were hidden for longer than their release delay
+   * if their HiddenPolicy allows it and restores them once they are visible again.
+   */
+  void updateHiddenOverlays( const std::chrono::high_resolution_clock::time_point &now );
+
+  /*!
+   * Collects the visible overlays that need to be rendered and are not limited by their max update
+   * rate into the render_queue_ in the order in which they should be rendered.
+   */
+  void scheduleOverlays( const std::chrono::high_resolution_clock::time_point &now );
+
+  /*!
+   * Renders the overlays in the render_queue_ into their layers until the frame time budget is
+   * exceeded.
+   * @return Whether any overlay was rendered.
+   */
+  bool renderScheduledOverlays( const std::chrono::high_resolution_clock::time_point &frame_start );
+
+  /*!
+   * Renders at most one hidden overlay that was never rendered into its layer if warm-up is enabled
+   * and the time since the last warm-up is long enough.
+   * @see warmUpEnabled()
+   */
+  void warmUpHiddenOverlay();
+
+  std::unordered_map<const Overlay *, OverlayState> overlay_states_;
+  std::vector<Overlay *> render_queue_;
+  double frame_time_budget_ms_ = 0;
+  float global_max_update_rate_ = 0;
+  bool suspended_ = false;
+  bool warm_up_enabled_ = false;
+  std::chrono::high_resolution_clock::time_point next_warm_up_;
+  float render_resolution_ = 1;
+  float effective_render_resolution_ = 1;
+  float min_adaptive_render_resolution_ = 0.5f;
+  bool adaptive_render_resolution_ = false;
+  double target_render_time_ms_ = 4;
+  double average_render_time_ms_ = 0;
+  //! Whether average_render_time_ms_ contains a measurement since it was last reset.
+  bool has_render_time_sample_ = false;
+  std::chrono::high_resolution_clock::time_point last_render_time_sample_;
+  std::chrono::high_resolution_clock::time_point next_resolution_update_;
+  //! The resolution of the layer that is currently rendered.
+  float layer_resolution_ = 1;
 };
 } // namespace hector_rviz_overlay
 
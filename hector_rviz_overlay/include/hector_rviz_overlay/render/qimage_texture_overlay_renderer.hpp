@@ -22,7 +22,8 @@
 
 #include <QImage>
 
-#include <OgreHardwarePixelBuffer.h>
+#include <unordered_map>
+#include <vector>
 
 namespace hector_rviz_overlay
 {
@@ -31,8 +32,11 @@ namespace hector_rviz_overlay
  * @class QImageTextureOverlayRenderer
  * @brief This class renders QWidgetOverlay's into a QImage.
  *
- * The texture's memory is wrapped by a QImage that is used as a paint device for the
- * QWidgetOverlays. This renderer does not support the rendering of QmlOverlays!
+ * Each overlay is rendered into its own QImage layer. The layers are composed into a persistent
+ * QImage that is split into tiles of TileSize x TileSize pixels. Only the tiles that are covered by
+ * a layer that was rendered again (before or after it was rendered) are composed anew and only the
+ * tiles whose content actually changed are uploaded to the texture.
+ * This renderer does not support the rendering of QmlOverlays!
  */
 class QImageTextureOverlayRenderer : public TextureOverlayRenderer
 {
@@ -53,12 +57,61 @@ public:
   QOpenGLContext *context() override;
 
 protected:
+  struct Layer {
+    QImage image;
+    //! Whether each tile of the composition is covered by visible content of the layer.
+    std::vector<unsigned char> tiles;
+  };
+
   void prepareRender( int width, int height ) override;
 
+  void beginOverlayRender( const Overlay &overlay ) override;
+
+  void endOverlayRender( const Overlay &overlay ) override;
+
+  void beginComposition() override;
+
+  void composeOverlay( const Overlay &overlay ) override;
+
+  void endComposition() override;
+
+  void releaseOverlayLayer( const Overlay &overlay ) override;
+
   void finishRender() override;
 
-  Ogre::HardwarePixelBufferSharedPtr buffer_;
+  //! Marks the tiles covered by the given layer as dirty, i.e., they have to be composed anew.
+  void markDirty( const Layer &layer );
+
+  /*!
+   * Composes the dirty tiles of the given row of tiles anew and marks the tiles whose content
+   * changed for the upload.
+   */
+  void composeTileRow( int row );
+
+  /*!
+   * Uploads the tiles that were marked for the upload to the texture.
+   * @return Whether any tile was uploaded.
+   */
+  bool uploadTiles();
+
+  //! The composition of all layers which persists between frames.
   QImage paint_device_image_;
+  QPaintDevice *current_paint_device_ = &paint_device_image_;
+  std::unordered_map<const Overlay *, Layer> layers_;
+  //! The overlays in the order in which they are composed in the current and the last composition.
+  std::vector<const Overlay *> composed_overlays_;
+  std::vector<const Overlay *> last_composed_overlays_;
+  //! A row of tiles is composed into this image to compare it with the last composition.
+  QImage tile_row_image_;
+  std::vector<unsigned char> dirty_tiles_;
+  std::vector<unsigned char> upload_tiles_;
+  //! The texture that the composition was uploaded to completely. A new texture has no content.
+  const Ogre::Texture *uploaded_texture_ = nullptr;
+  bool upload_all_ = true;
+  int composition_columns_ = 0;
+  int composition_rows_ = 0;
+  int width_ = 0;
+  int height_ = 0;
 };
 } // namespace hector_rviz_overlay
 
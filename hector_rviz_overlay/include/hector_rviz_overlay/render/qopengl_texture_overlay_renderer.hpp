@@ -7,6 +7,9 @@
 
 #include "hector_rviz_overlay/render/texture_overlay_renderer.hpp"
 
+#include <memory>
+#include <unordered_map>
+
 namespace hector_rviz_overlay
 {
 class QOpenGLWrapper;
@@ -36,9 +39,23 @@ protected:
 
   void prepareRender( int width, int height ) override;
 
+  void beginOverlayRender( const Overlay &overlay ) override;
+
+  void endOverlayRender( const Overlay &overlay ) override;
+
+  void beginComposition() override;
+
+  void composeOverlay( const Overlay &overlay ) override;
+
+  void releaseOverlayLayer( const Overlay &overlay ) override;
+
   void finishRender() override;
 
+  void finishOffscreenRender() override;
+
   std::unique_ptr<QOpenGLWrapper> qopengl_wrapper_;
+  //! One layer per rendered overlay at the render panel's size (times the resolution scale).
+  std::unordered_map<const Overlay *, std::unique_ptr<QOpenGLFramebufferObject>> layers_;
   std::vector<unsigned char> pixel_data_;
   bool framebuffer_object_updated_ = false;
 };
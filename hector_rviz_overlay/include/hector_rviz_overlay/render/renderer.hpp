@@ -52,6 +52,13 @@ public:
   virtual QOpenGLContext *context() = 0;
 
   virtual QWindow *window() = 0;
+
+  /*!
+   * The layer of an overlay that supports a reduced resolution (see
+   * Overlay::supportsResolutionScale()) may be smaller than the overlay's geometry.
+   * @return The factor by which the overlay currently rendered has to scale its content.
+   */
+  virtual float resolutionScale() const noexcept = 0;
 };
 } // namespace hector_rviz_overlay
 
@@ -23,10 +23,14 @@
 #include <OgreMaterial.h>
 #include <OgreTexture.h>
 
+#include <vector>
+
 namespace Ogre
 {
+class ManualObject;
 class Overlay;
-class OverlayContainer;
+class SceneManager;
+class SceneNode;
 } // namespace Ogre
 
 namespace rviz_common
@@ -43,10 +47,17 @@ namespace hector_rviz_overlay
  *
  * Provides implementations to create and register an Ogre overlay using a texture that is drawn on top of the scene.
  * Also handles resizing the texture and makes sure the rendering is done after each frame.
+ *
+ * Instead of blending a quad covering the whole render panel, the texture is divided into tiles
+ * of TileSize x TileSize pixels and only the tiles that contain visible content are drawn, hence,
+ * the transparent parts of the overlays do not cost any fill-rate.
  */
 class TextureOverlayRenderer : public OverlayRenderer
 {
 public:
+  //! The width and height of the tiles in pixels.
+  static constexpr int TileSize = 64;
+
   explicit TextureOverlayRenderer( rviz_common::DisplayContext *context );
 
   ~TextureOverlayRenderer() override;
@@ -87,8 +98,30 @@ protected:
    */
   virtual void updateTexture( unsigned int texture_width, unsigned int texture_height );
 
+  /*!
+   * Determines which tiles contain visible content and rebuilds the mesh that draws the texture if
+   * the set of occupied tiles changed. Should be called by subclasses in finishRender with the
+   * final image, i.e., only if the content changed.
+   * @param data The pixels of the final image with premultiplied alpha and 4 bytes per pixel.
+   * @param bytes_per_line The number of bytes per line of the data.
+   * @param bottom_up Whether the first line of the data is the bottom line of the image.
+   */
+  void updateTiles( const unsigned char *data, int bytes_per_line, bool bottom_up );
+
+  /*!
+   * Determines for each tile of an image whether it contains a pixel that is not fully transparent.
+   * @param data The pixels of the image with premultiplied alpha and 4 bytes per pixel.
+   * @param width The width of the image.
+   * @param height The height of the image.
+   * @param bytes_per_line The number of bytes per line of the data.
+   * @param bottom_up Whether the first line of the data is the bottom line of the image.
+   * @param occupancy Set to whether each tile (row-major, top to bottom) is occupied.
+   */
+  static void computeTileOccupancy( const unsigned char *data, int width, int height,
+                                    int bytes_per_line, bool bottom_up,
+                                    std::vector<unsigned char> &occupancy );
+
   Ogre::Overlay *ogre_overlay_;
-  Ogre::OverlayContainer *overlay_panel_;
   Ogre::MaterialPtr material_;
   Ogre::TexturePtr texture_;
   Ogre::TextureUnitState *texture_unit_state_;
@@ -99,8 +132,22 @@ protected:
 private:
   class RenderTargetListener;
 
+  //! Rebuilds the tile mesh from the tile occupancy, merging adjacent tiles in a row into one quad.
+  void rebuildTileMesh();
+
   RenderTargetListener *render_target_listener_;
 
+  Ogre::SceneManager *scene_manager_;
+  Ogre::SceneNode *tile_node_;
+  Ogre::ManualObject *tile_mesh_;
+  //! Whether each tile (row-major, top to bottom) contains visible content.
+  std::vector<unsigned char> tile_occupancy_;
+  std::vector<unsigned char> next_tile_occupancy_;
+  int tile_columns_ = 0;
+  //! The panel size the tile mesh was built for.
+  int mesh_width_ = 0;
+  int mesh_height_ = 0;
+
   int last_width_ = 0;
   int last_height_ = 0;
 
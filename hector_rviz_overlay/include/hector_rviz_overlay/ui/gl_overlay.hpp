@@ -0,0 +1,99 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_GL_OVERLAY_H
+#define HECTOR_RVIZ_OVERLAY_GL_OVERLAY_H
+
+#include "ui_overlay.hpp"
+
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class GlOverlay
+ * @brief An overlay that draws using raw OpenGL calls directly into the overlay's framebuffer.
+ *
+ * Intended for dense visualizations, e.g., waterfalls or heatmaps, that would be too slow to draw
+ * using a QPainter. Subclasses implement paintGl and create their GPU resources in initializeGl
+ * and delete them in releaseGl. All three are called with the renderer's context current.
+ *
+ * The OpenGL state that is changed by paintGl (capabilities, blending, viewport, scissor box,
+ * masks, bound program, buffers, vertex array and textures) is saved before and restored after
+ * paintGl, so it does not interfere with other overlays.
+ * Like all overlays, the overlay is only rendered when it is dirty. Call requestRender() whenever
+ * the content changed.
+ *
+ * Requires the OpenGL overlay renderer. With the QImage renderer, the overlay is not drawn.
+ */
+class GlOverlay : public UiOverlay
+{
+  Q_OBJECT
+public:
+  explicit GlOverlay( const std::string &name );
+
+  ~GlOverlay() override;
+
+  ///@inherit
+  void prepareRender( Renderer *renderer ) override;
+
+  ///@inherit
+  void releaseRenderResources() override;
+
+  ///@inherit
+  bool handleEvent( QObject *, QEvent * ) override { return false; }
+
+  ///@inherit
+  void handleEventsCanceled() override { }
+
+  //! @return Whether the renderer provides an OpenGL context and initializeGl was called.
+  bool isGlInitialized() const { return context_ != nullptr; }
+
+protected:
+  /*!
+   * Called once with the context current before the first paintGl and again after the resources
+   * were released, e.g., because the overlay was hidden with the ReleaseWhenHidden policy.
+   */
+  virtual void initializeGl( QOpenGLContext *context ) { (void)context; }
+
+  /*!
+   * Draws the content of the overlay. The framebuffer is bound, cleared and the viewport covers
+   * the whole framebuffer. The framebuffer has a depth and stencil attachment and is multisampled.
+   * The overlay's scale is not applied.
+   *
+   * @param context The current context.
+   * @param framebuffer The framebuffer of this overlay's layer.
+   */
+  virtual void paintGl( QOpenGLContext *context, QOpenGLFramebufferObject *framebuffer ) = 0;
+
+  //! Called with the context current to delete the resources created in initializeGl.
+  virtual void releaseGl( QOpenGLContext *context ) { (void)context; }
+
+  ///@inherit
+  void renderImpl( Renderer *renderer ) override;
+
+private:
+  QOpenGLContext *context_ = nullptr;
+};
+
+typedef std::shared_ptr<GlOverlay> GlOverlayPtr;
+typedef std::shared_ptr<const GlOverlay> GlOverlayConstPtr;
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_GL_OVERLAY_H
@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#ifndef HECTOR_RVIZ_OVERLAY_PAINTER_OVERLAY_H
+#define HECTOR_RVIZ_OVERLAY_PAINTER_OVERLAY_H
+
+#include "hector_rviz_overlay/helper/painter_command_list.hpp"
+#include "ui_overlay.hpp"
+
+#include <QSize>
+
+#include <atomic>
+#include <mutex>
+
+namespace hector_rviz_overlay
+{
+
+/*!
+ * @class PainterOverlay
+ * @brief A lightweight overlay that draws a retained list of primitive draw commands.
+ *
+ * Intended for simple HUD elements that are updated at a high rate, e.g., crosshairs, range rings
+ * or numeric readouts updated from ROS callbacks, for which a widget tree or a QML engine would be
+ * too heavy.
+ * Producers on any thread record a new frame using beginFrame() which is published when the
+ * returned Frame is destroyed. The render thread only replays the commands with a QPainter if a
+ * new frame was published or the geometry changed. Otherwise, the last rendered content is shown.
+ *
+ * The command lists are triple buffered: The producer records into the back list while the render
+ * thread replays the front list and the third list holds the latest published frame. Hence, neither
+ * side ever waits for the other and since the lists are reused, recording does not allocate once
+ * the lists have grown to the size of the largest frame.
+ *
+ * The overlay does not handle any events.
+ */
+class PainterOverlay : public UiOverlay
+{
+  Q_OBJECT
+public:
+  /*!
+   * @class Frame
+   * @brief Provides access to an empty command list and publishes it on destruction.
+   *
+   * Only one frame can be recorded at a time. Other threads calling beginFrame() block until the
+   * current frame is published.
+   */
+  class Frame
+  {
+  public:
+    Frame( Frame &&other ) noexcept;
+
+    Frame( const Frame & ) = delete;
+
+    Frame &operator=( const Frame & ) = delete;
+
+    Frame &operator=( Frame && ) = delete;
+
+    //! Publishes the recorded commands.
+    ~Frame();
+
+    PainterCommandList &commands() { return *commands_; }
+
+    PainterCommandList *operator->() { return commands_; }
+
+  private:
+    friend class PainterOverlay;
+
+    Frame( PainterOverlay *overlay, std::unique_lock<std::mutex> lock );
+
+    PainterOverlay *overlay_;
+    std::unique_lock<std::mutex> lock_;
+    PainterCommandList *commands_;
+  };
+
+  explicit PainterOverlay( const std::string &name );
+
+  ~PainterOverlay() override;
+
+  /*!
+   * Starts recording a new frame. The coordinates are in the unscaled content coordinates, i.e.,
+   * the overlay's scale is applied when replaying. Thread-safe.
+   * @return A frame with an empty command list which is published when the frame is destroyed.
+   */
+  Frame beginFrame();
+
+  //! Publishes an empty frame. Thread-safe.
+  void clear();
+
+  /*!
+   * The size of the area the commands are drawn into, i.e., the size of the geometry divided by the
+   * scale. Thread-safe.
+   */
+  QSize contentSize() const;
+
+  ///@inherit
+  void prepareRender( Renderer * ) override { }
+
+  ///@inherit
+  void releaseRenderResources() override { }
+
+  ///@inherit
+  bool handleEvent( QObject *, QEvent * ) override { return false; }
+
+  ///@inherit
+  void handleEventsCanceled() override { }
+
+  ///@inherit
+  void setScale( float value ) override;
+
+  ///@inherit
+  void setGeometry( const QRect &value ) override;
+
+  bool supportsResolutionScale() const override { return true; }
+
+protected:
+  ///@inherit
+  void renderImpl( Renderer *renderer ) override;
+
+private:
+  void publish();
+
+  void updateContentSize();
+
+  static constexpr int IndexMask = 3;
+  static constexpr int NewFrameFlag = 4;
+
+  PainterCommandList command_lists_[3];
+  std::mutex producer_mutex_;
+  //! The list the producer records into. Guarded by producer_mutex_.
+  int back_index_ = 0;
+  //! The latest published list. Flagged with NewFrameFlag until the render thread picks it up.
+  std::atomic<int> shared_index_{ 1 };
+  //! The list that is replayed. Only accessed by the render thread.
+  int front_index_ = 2;
+  std::atomic<int> content_width_{ 0 };
+  std::atomic<int> content_height_{ 0 };
+};
+
+typedef std::shared_ptr<PainterOverlay> PainterOverlayPtr;
+typedef std::shared_ptr<const PainterOverlay> PainterOverlayConstPtr;
+} // namespace hector_rviz_overlay
+
+#endif // HECTOR_RVIZ_OVERLAY_PAINTER_OVERLAY_H
@@ -20,6 +20,7 @@
 
 #include "ui_overlay.hpp"
 
+#include <QPointer>
 #include <QVariantMap>
 
 class QQmlComponent;
@@ -74,10 +75,15 @@ public:
   /// @inherit
   void setGeometry( const QRect &value ) override;
 
+  //! The scene is rendered into a render target of the layer's size with a reduced content scale.
+  bool supportsResolutionScale() const override { return true; }
+
   /*!
    * Loads the qml file from the provided path.
    * The path can be specified either as an absolute path or a package relative path.
    * A package relative path has the following format: "package://{package_name}/{relative_path_in_package}".
+   * If the file was compiled into the package's library using hector_rviz_overlay_add_qml_resources,
+   * the precompiled resource is loaded instead (see resolveQmlUrl).
    *
    * @param path The path to the qml file.
    * @return True if loading the qml file was successful, false otherwise
@@ -151,9 +157,27 @@ protected slots:
 
   void onVisibilityChanged();
 
+  /*!
+   * Pauses the animations and timers of the scene while the overlay is hidden and its HiddenPolicy
+   * is not KeepWarm, and resumes them once it is shown again.
+   */
+  void updateAnimationSuspension();
+
 protected:
   bool createRootItem();
 
+  /*!
+   * Sends the event to the quick window. The positions of mouse and wheel events are mapped to the
+   * window at the current resolution scale.
+   */
+  void sendEventToWindow( QEvent *event );
+
+  //! Pauses all running top-level animations and stops all running timers of the scene.
+  void suspendAnimations();
+
+  //! Resumes the animations and restarts the timers stopped by suspendAnimations.
+  void resumeAnimations();
+
   void updateGeometry();
 
   /// @inherit
@@ -163,6 +187,7 @@ protected:
 
   class UrlInterceptor;
   UrlInterceptor *url_interceptor_ = nullptr;
+  class RenderControl;
   std::vector<std::string> loaded_files_;
 
   QWindow *rviz_window_;
@@ -173,9 +198,16 @@ protected:
   QQuickItem *root_item_ = nullptr;
   QVariantMap configuration_;
   QmlRvizContext *qml_rviz_context_ = nullptr;
+  //! The animations paused and timers stopped by suspendAnimations.
+  std::vector<QPointer<QObject>> paused_animations_;
+  std::vector<QPointer<QObject>> stopped_timers_;
+
+  //! The resolution scale of the layer the scene was last rendered into.
+  float resolution_scale_ = 1;
 
   bool reload_required_ = false;
   bool scene_changed_ = true;
+  bool animation_driver_acquired_ = false;
   bool sending_event_ = false;
 
   QString path_;
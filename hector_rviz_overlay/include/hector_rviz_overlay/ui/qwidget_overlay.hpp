@@ -20,6 +20,11 @@
 
 #include "ui_overlay.hpp"
 
+#include <QImage>
+
+#include <future>
+#include <limits>
+
 class QKeyEvent;
 class QMouseEvent;
 class QWheelEvent;
@@ -38,6 +43,30 @@ class QWidgetOverlay : public UiOverlay
 {
   Q_OBJECT
 public:
+  //! Determines how the widget tree is drawn into the overlay.
+  enum RenderMode {
+    //! The widgets are painted directly onto the renderer's paint device each frame. (Default)
+    Direct,
+    /*!
+     * The widgets are painted into a cached image using the raster paint engine which is much
+     * faster than the OpenGL paint engine for typical widgets. The image is only painted again
+     * after a widget called update() and the overlay is only rendered, and the image only uploaded,
+     * if the image changed.
+     * To observe the updates, the top level widget is shown without a window
+     * (Qt::WA_DontShowOnScreen). Hence, Qt additionally paints the updated regions into the
+     * widget's backing store which is a full-size image.
+     */
+    Raster,
+    /*!
+     * Like Raster but the widgets are only recorded into a QPicture on the GUI thread which is
+     * cheap compared to painting them. The recording is played back and compared to the cached
+     * image on a worker thread, hence, multiple overlays are rasterized in parallel and while rviz
+     * renders the frame. Changes are shown with the next update.
+     */
+    ParallelRaster
+  };
+  Q_ENUM( RenderMode )
+
   explicit QWidgetOverlay( const std::string &name );
 
   ~QWidgetOverlay() override;
@@ -45,9 +74,6 @@ public:
   ///@inherit
   void prepareRender( Renderer * ) override { }
 
-  ///@inherit
-  void releaseRenderResources() override { }
-
   ///@inherit
   bool handleEvent( QObject *receiver, QEvent *event ) override;
 
@@ -71,12 +97,48 @@ public:
 
   bool isDirty() const override;
 
+  //! Widgets are painted at the layer's resolution in all render modes.
+  bool supportsResolutionScale() const override { return true; }
+
+  ///@inherit
+  void update( float dt ) override;
+
+  ///@inherit
+  void releaseRenderResources() override;
+
+  //! @see RenderMode
+  RenderMode renderMode() const { return render_mode_; }
+
+  //! @see renderMode()
+  void setRenderMode( RenderMode value );
+
 protected:
   ///@inherit
   void renderImpl( Renderer *renderer ) override;
 
+  bool eventFilter( QObject *watched, QEvent *event ) override;
+
   OverlayWidget *widget_;
   QWidgetEventManager *event_manager_;
+
+private:
+  //! Waits for the pending rasterization in ParallelRaster mode and swaps in a changed result.
+  void collectParallelRaster();
+
+  RenderMode render_mode_ = Direct;
+  //! The last rasterized content that is drawn in Raster mode.
+  QImage raster_image_;
+  //! The image the widgets are rasterized into to check whether the content changed.
+  QImage back_image_;
+  //! The resolution scale of the last render which the widgets are rasterized at.
+  float resolution_scale_ = 1;
+  //! The scale the raster image was painted at.
+  float last_raster_scale_ = 0;
+  //! Whether a widget requested an update since the last rasterization.
+  bool damaged_ = true;
+  //! Ready once the worker rasterized the picture into the back image. True if it changed.
+  std::future<bool> raster_result_;
+  float time_since_raster_ = std::numeric_limits<float>::infinity();
 };
 
 typedef std::shared_ptr<QWidgetOverlay> QWidgetOverlayPtr;
@@ -20,6 +20,7 @@
 #include "hector_rviz_overlay/overlay_manager.hpp"
 
 #include <rviz_common/display_context.hpp>
+#include <rviz_common/properties/enum_property.hpp>
 #include <rviz_common/properties/float_property.hpp>
 #include <rviz_common/properties/int_property.hpp>
 #include <rviz_common/view_manager.hpp>
@@ -43,6 +44,27 @@ OverlayDisplay::OverlayDisplay( bool allow_multiple )
       this, SLOT( onScaleChanged() ) );
   scale_property_->setMin( 0.1f );
   scale_property_->setMax( 10.0f );
+  render_priority_property_ = new rviz_common::properties::IntProperty(
+      "Render Priority", 0,
+      "If not all overlays can be rendered within the frame time budget, overlays with a higher priority are rendered first.",
+      this, SLOT( onRenderPriorityChanged() ) );
+  max_update_rate_property_ = new rviz_common::properties::FloatProperty(
+      "Max Update Rate", 0.0f,
+      "The maximum number of times per second the overlay is rendered. Changes in between are shown with the next render. 0 for unlimited.",
+      this, SLOT( onMaxUpdateRateChanged() ) );
+  max_update_rate_property_->setMin( 0.0f );
+  hidden_policy_property_ = new rviz_common::properties::EnumProperty(
+      "When Hidden", "Keep Warm",
+      "Keep Warm: The overlay is updated and keeps its resources. Suspend: The overlay is not updated but keeps its resources. Release: The render resources are released after the release delay and restored when the overlay is shown again.",
+      this, SLOT( onHiddenPolicyChanged() ) );
+  hidden_policy_property_->addOption( "Keep Warm", Overlay::KeepWarm );
+  hidden_policy_property_->addOption( "Suspend", Overlay::Suspend );
+  hidden_policy_property_->addOption( "Release", Overlay::ReleaseWhenHidden );
+  release_delay_property_ = new rviz_common::properties::FloatProperty(
+      "Release Delay", 30.0f,
+      "The time in seconds the overlay has to be hidden before its render resources are released if the policy is Release.",
+      hidden_policy_property_, SLOT( onHiddenPolicyChanged() ), this );
+  release_delay_property_->setMin( 0.0f );
 }
 
 OverlayDisplay::~OverlayDisplay()
@@ -66,6 +88,29 @@ void OverlayDisplay::onZIndexChanged()
   overlay_->setZIndex( z_index_property_->getInt() );
 }
 
+void OverlayDisplay::onRenderPriorityChanged()
+{
+  if ( overlay_ == nullptr )
+    return;
+  overlay_->setRenderPriority( render_priority_property_->getInt() );
+}
+
+void OverlayDisplay::onMaxUpdateRateChanged()
+{
+  if ( overlay_ == nullptr )
+    return;
+  overlay_->setMaxUpdateRate( max_update_rate_property_->getFloat() );
+}
+
+void OverlayDisplay::onHiddenPolicyChanged()
+{
+  if ( overlay_ == nullptr )
+    return;
+  overlay_->setHiddenPolicy(
+      static_cast<Overlay::HiddenPolicy>( hidden_policy_property_->getOptionInt() ) );
+  overlay_->setReleaseDelay( release_delay_property_->getFloat() );
+}
+
 void OverlayDisplay::onInitialize()
 {
   using namespace rviz_common::properties;
@@ -21,6 +21,7 @@
 #include <QFile>
 #include <QWidget>
 
+#include <rviz_common/properties/bool_property.hpp>
 #include <rviz_common/properties/editable_enum_property.hpp>
 
 namespace hector_rviz_overlay
@@ -37,12 +38,24 @@ QWidgetOverlayDisplay::QWidgetOverlayDisplay( bool allow_multiple )
       "Can be either a style sheet or a path to a style sheet. "
       "Use package://{package}/ to access package relative paths.",
       this, SLOT( updateStyleSheet() ) );
+  rasterize_property_ = new rviz_common::properties::BoolProperty(
+      "Rasterize", false,
+      "Paints the widgets into a cached image using the raster paint engine. "
+      "Usually faster than painting with OpenGL and the overlay is only redrawn if the image "
+      "changed.",
+      this, SLOT( onRasterizeChanged() ) );
+  parallel_raster_property_ = new rviz_common::properties::BoolProperty(
+      "Parallel", false,
+      "Records the widgets on the GUI thread and rasterizes them on a worker thread. "
+      "Only rasterizes if the recording changed.",
+      rasterize_property_, SLOT( onRasterizeChanged() ), this );
 }
 
 void QWidgetOverlayDisplay::onInitialize()
 {
   OverlayDisplay::onInitialize();
   updateStyleSheet();
+  onRasterizeChanged();
 
   onSetupUi( qwidget_overlay_->widget() );
 }
@@ -53,6 +66,17 @@ UiOverlayPtr QWidgetOverlayDisplay::createOverlay()
   return qwidget_overlay_;
 }
 
+void QWidgetOverlayDisplay::onRasterizeChanged()
+{
+  if ( qwidget_overlay_ == nullptr )
+    return;
+  QWidgetOverlay::RenderMode mode = QWidgetOverlay::Direct;
+  if ( rasterize_property_->getBool() )
+    mode = parallel_raster_property_->getBool() ? QWidgetOverlay::ParallelRaster
+                                                : QWidgetOverlay::Raster;
+  qwidget_overlay_->setRenderMode( mode );
+}
+
 void QWidgetOverlayDisplay::updateStyleSheet()
 {
   if ( overlay_ == nullptr )
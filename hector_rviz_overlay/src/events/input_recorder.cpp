@@ -0,0 +1,200 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/events/input_recorder.hpp"
+
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QWidget>
+
+#include "../logging.hpp"
+
+namespace hector_rviz_overlay
+{
+namespace
+{
+// "HROI" in little endian
+constexpr quint32 TraceMagic = 0x494F5248;
+constexpr quint16 TraceVersion = 1;
+
+void prepareStream( QDataStream &stream )
+{
+  stream.setByteOrder( QDataStream::LittleEndian );
+  stream.setFloatingPointPrecision( QDataStream::SinglePrecision );
+  stream.setVersion( QDataStream::Qt_5_12 );
+}
+
+bool isMouseEvent( QEvent::Type type )
+{
+  return type == QEvent::MouseMove || type == QEvent::MouseButtonPress ||
+         type == QEvent::MouseButtonRelease || type == QEvent::MouseButtonDblClick;
+}
+} // namespace
+
+InputRecorder::InputRecorder( QWidget *render_panel ) : render_panel_( render_panel ) { }
+
+InputRecorder::~InputRecorder() { stop(); }
+
+bool InputRecorder::start( const QString &path )
+{
+  stop();
+  file_.setFileName( path );
+  if ( !file_.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+    LOG_ERROR( "InputRecorder: Failed to open '%s' for writing: %s", path.toStdString().c_str(),
+               file_.errorString().toStdString().c_str() );
+    return false;
+  }
+  stream_.setDevice( &file_ );
+  prepareStream( stream_ );
+  stream_ << TraceMagic << TraceVersion;
+  recorded_events_ = 0;
+  last_time_us_ = 0;
+  timer_.start();
+  qApp->installEventFilter( this );
+  LOG_INFO( "InputRecorder: Recording input to '%s'.", path.toStdString().c_str() );
+  return true;
+}
+
+void InputRecorder::stop()
+{
+  if ( !file_.isOpen() )
+    return;
+  qApp->removeEventFilter( this );
+  stream_.setDevice( nullptr );
+  file_.close();
+  LOG_INFO( "InputRecorder: Recorded %zu events.", recorded_events_ );
+}
+
+bool InputRecorder::isRecording() const { return file_.isOpen(); }
+
+size_t InputRecorder::recordedEvents() const { return recorded_events_; }
+
+bool InputRecorder::eventFilter( QObject *receiver, QEvent *event )
+{
+  // Only record events delivered to windows. They are delivered to widgets by the window afterwards
+  // which would otherwise be recorded again.
+  if ( receiver == nullptr || !receiver->isWindowType() || render_panel_ == nullptr )
+    return false;
+  QEvent::Type type = event->type();
+  bool is_mouse = isMouseEvent( type );
+  bool is_wheel = type == QEvent::Wheel;
+  bool is_key = type == QEvent::KeyPress || type == QEvent::KeyRelease;
+  if ( !is_mouse && !is_wheel && !is_key )
+    return false;
+
+  QPointF position;
+  if ( is_mouse || is_wheel ) {
+    QPointF global_pos = is_mouse ? static_cast<QMouseEvent *>( event )->screenPos()
+                                  : static_cast<QWheelEvent *>( event )->globalPosition();
+    QPointF panel_pos = global_pos - QPointF( render_panel_->mapToGlobal( QPoint( 0, 0 ) ) );
+    QSize size = render_panel_->size();
+    if ( size.isEmpty() )
+      return false;
+    position = QPointF( panel_pos.x() / size.width(), panel_pos.y() / size.height() );
+  }
+
+  // Store the time relative to the previous event to keep the file compact
+  qint64 time_us = timer_.nsecsElapsed() / 1000;
+  stream_ << static_cast<quint32>( time_us - last_time_us_ ) << static_cast<quint16>( type )
+          << static_cast<float>( position.x() ) << static_cast<float>( position.y() );
+  last_time_us_ = time_us;
+  if ( is_mouse ) {
+    auto mouse_event = static_cast<QMouseEvent *>( event );
+    stream_ << static_cast<quint32>( mouse_event->button() )
+            << static_cast<quint32>( mouse_event->buttons() )
+            << static_cast<quint32>( mouse_event->modifiers() );
+  } else if ( is_wheel ) {
+    auto wheel_event = static_cast<QWheelEvent *>( event );
+    stream_ << static_cast<qint16>( wheel_event->angleDelta().x() )
+            << static_cast<qint16>( wheel_event->angleDelta().y() )
+            << static_cast<quint32>( wheel_event->buttons() )
+            << static_cast<quint32>( wheel_event->modifiers() );
+  } else {
+    auto key_event = static_cast<QKeyEvent *>( event );
+    stream_ << static_cast<qint32>( key_event->key() )
+            << static_cast<quint32>( key_event->modifiers() )
+            << static_cast<quint8>( key_event->isAutoRepeat() ) << key_event->text();
+  }
+  ++recorded_events_;
+  return false;
+}
+
+bool loadInputTrace( const QString &path, std::vector<RecordedInputEvent> &events )
+{
+  QFile file( path );
+  if ( !file.open( QIODevice::ReadOnly ) ) {
+    LOG_ERROR( "Failed to open input trace '%s': %s", path.toStdString().c_str(),
+               file.errorString().toStdString().c_str() );
+    return false;
+  }
+  QDataStream stream( &file );
+  prepareStream( stream );
+  quint32 magic;
+  quint16 version;
+  stream >> magic >> version;
+  if ( magic != TraceMagic || version != TraceVersion ) {
+    LOG_ERROR( "'%s' is not a valid input trace or has an unsupported version.",
+               path.toStdString().c_str() );
+    return false;
+  }
+
+  events.clear();
+  qint64 time_us = 0;
+  while ( !stream.atEnd() ) {
+    RecordedInputEvent event;
+    quint32 dt_us;
+    quint16 type;
+    float x, y;
+    stream >> dt_us >> type >> x >> y;
+    time_us += dt_us;
+    event.time_us = time_us;
+    event.type = static_cast<QEvent::Type>( type );
+    event.position = QPointF( x, y );
+    quint32 buttons, modifiers;
+    if ( isMouseEvent( event.type ) ) {
+      quint32 button;
+      stream >> button >> buttons >> modifiers;
+      event.button = static_cast<Qt::MouseButton>( button );
+    } else if ( event.type == QEvent::Wheel ) {
+      qint16 angle_x, angle_y;
+      stream >> angle_x >> angle_y >> buttons >> modifiers;
+      event.angle_delta = QPoint( angle_x, angle_y );
+    } else if ( event.type == QEvent::KeyPress || event.type == QEvent::KeyRelease ) {
+      qint32 key;
+      quint8 auto_repeat;
+      buttons = 0;
+      stream >> key >> modifiers >> auto_repeat >> event.text;
+      event.key = key;
+      event.auto_repeat = auto_repeat != 0;
+    } else {
+      LOG_ERROR( "Input trace '%s' contains an unknown event type.", path.toStdString().c_str() );
+      return false;
+    }
+    if ( stream.status() != QDataStream::Ok ) {
+      // E.g., if rviz crashed while recording. Keep the complete events.
+      LOG_WARN( "Input trace '%s' is truncated.", path.toStdString().c_str() );
+      break;
+    }
+    event.buttons = Qt::MouseButtons( QFlag( static_cast<int>( buttons ) ) );
+    event.modifiers = Qt::KeyboardModifiers( QFlag( static_cast<int>( modifiers ) ) );
+    events.push_back( std::move( event ) );
+  }
+  return true;
+}
+} // namespace hector_rviz_overlay
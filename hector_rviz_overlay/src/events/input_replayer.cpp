@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/events/input_replayer.hpp"
+
+#include <QCoreApplication>
+#include <QKeyEvent>
+#include <QMetaEnum>
+#include <QMouseEvent>
+#include <QWheelEvent>
+#include <QWidget>
+#include <QWindow>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numeric>
+
+#include "../logging.hpp"
+
+namespace hector_rviz_overlay
+{
+namespace
+{
+InputLatencyStats computeStats( std::vector<double> &latencies )
+{
+  InputLatencyStats stats;
+  if ( latencies.empty() )
+    return stats;
+  std::sort( latencies.begin(), latencies.end() );
+  // Nearest-rank percentiles
+  auto percentile = [&latencies]( double p ) {
+    size_t rank = static_cast<size_t>( std::ceil( p * latencies.size() ) );
+    return latencies[std::min( latencies.size(), std::max<size_t>( rank, 1 ) ) - 1];
+  };
+  stats.count = latencies.size();
+  stats.mean_us = std::accumulate( latencies.begin(), latencies.end(), 0.0 ) / latencies.size();
+  stats.p50_us = percentile( 0.5 );
+  stats.p90_us = percentile( 0.9 );
+  stats.p99_us = percentile( 0.99 );
+  stats.max_us = latencies.back();
+  return stats;
+}
+
+QString formatStats( const QString &name, const InputLatencyStats &stats )
+{
+  return QString( "%1 %2 %3 %4 %5 %6 %7\n" )
+      .arg( name, -20 )
+      .arg( stats.count, 8 )
+      .arg( stats.mean_us, 10, 'f', 1 )
+      .arg( stats.p50_us, 10, 'f', 1 )
+      .arg( stats.p90_us, 10, 'f', 1 )
+      .arg( stats.p99_us, 10, 'f', 1 )
+      .arg( stats.max_us, 10, 'f', 1 );
+}
+} // namespace
+
+QString InputReplayReport::toString() const
+{
+  QString result = QString( "%1 %2 %3 %4 %5 %6 %7\n" )
+                       .arg( "Event (us)", -20 )
+                       .arg( "Count", 8 )
+                       .arg( "Mean", 10 )
+                       .arg( "P50", 10 )
+                       .arg( "P90", 10 )
+                       .arg( "P99", 10 )
+                       .arg( "Max", 10 );
+  QMetaEnum event_types = QMetaEnum::fromType<QEvent::Type>();
+  for ( const auto &entry : by_type ) {
+    const char *name = event_types.valueToKey( entry.first );
+    result += formatStats( name != nullptr ? QString( name ) : QString::number( entry.first ),
+                           entry.second );
+  }
+  result += formatStats( "All", all );
+  return result;
+}
+
+InputReplayer::InputReplayer( QWidget *render_panel ) : render_panel_( render_panel ) { }
+
+bool InputReplayer::load( const QString &path ) { return loadInputTrace( path, events_ ); }
+
+const std::vector<RecordedInputEvent> &InputReplayer::events() const { return events_; }
+
+void InputReplayer::setEvents( std::vector<RecordedInputEvent> events )
+{
+  events_ = std::move( events );
+}
+
+InputReplayReport InputReplayer::replay( int repetitions )
+{
+  InputReplayReport report;
+  if ( render_panel_ == nullptr || render_panel_->window()->windowHandle() == nullptr ) {
+    LOG_ERROR( "InputReplayer: The render panel has no window to send the events to." );
+    return report;
+  }
+  QWindow *window = render_panel_->window()->windowHandle();
+  const QPoint panel_top_left = render_panel_->mapToGlobal( QPoint( 0, 0 ) );
+  const QSizeF panel_size = render_panel_->size();
+
+  std::vector<double> latencies;
+  std::map<QEvent::Type, std::vector<double>> latencies_by_type;
+  latencies.reserve( events_.size() * std::max( repetitions, 0 ) );
+  QElapsedTimer timer;
+  for ( int repetition = 0; repetition < repetitions; ++repetition ) {
+    for ( const RecordedInputEvent &recorded : events_ ) {
+      QPointF global_pos( panel_top_left.x() + recorded.position.x() * panel_size.width(),
+                          panel_top_left.y() + recorded.position.y() * panel_size.height() );
+      QPointF local_pos = window->mapFromGlobal( global_pos.toPoint() );
+      std::unique_ptr<QEvent> event;
+      switch ( recorded.type ) {
+      case QEvent::MouseMove:
+      case QEvent::MouseButtonPress:
+      case QEvent::MouseButtonRelease:
+      case QEvent::MouseButtonDblClick:
+        event = std::make_unique<QMouseEvent>( recorded.type, local_pos, local_pos, global_pos,
+                                               recorded.button, recorded.buttons,
+                                               recorded.modifiers );
+        break;
+      case QEvent::Wheel:
+        event = std::make_unique<QWheelEvent>( local_pos, global_pos, QPoint(),
+                                               recorded.angle_delta, recorded.buttons,
+                                               recorded.modifiers, Qt::NoScrollPhase, false );
+        break;
+      case QEvent::KeyPress:
+      case QEvent::KeyRelease:
+        event = std::make_unique<QKeyEvent>( recorded.type, recorded.key, recorded.modifiers,
+                                             recorded.text, recorded.auto_repeat );
+        break;
+      default:
+        continue;
+      }
+
+      timer.start();
+      QCoreApplication::sendEvent( window, event.get() );
+      double latency_us = timer.nsecsElapsed() / 1000.0;
+      latencies.push_back( latency_us );
+      latencies_by_type[recorded.type].push_back( latency_us );
+    }
+  }
+
+  report.all = computeStats( latencies );
+  for ( auto &entry : latencies_by_type ) {
+    report.by_type[entry.first] = computeStats( entry.second );
+  }
+  return report;
+}
+} // namespace hector_rviz_overlay
@@ -17,6 +17,8 @@
 
 #include "hector_rviz_overlay/events/qwidget_event_manager.hpp"
 
+#include "hector_rviz_overlay/events/widget_hit_test_cache.hpp"
+
 #include "hector_rviz_overlay/overlay_widget.hpp"
 
 #include <QApplication>
@@ -26,7 +28,10 @@
 namespace hector_rviz_overlay
 {
 
-QWidgetEventManager::QWidgetEventManager( QWidget *widget ) : widget_( widget ) { }
+QWidgetEventManager::QWidgetEventManager( QWidget *widget )
+    : widget_( widget ), hit_test_cache_( std::make_unique<WidgetHitTestCache>( widget ) )
+{
+}
 
 QWidgetEventManager::~QWidgetEventManager() = default;
 
@@ -70,7 +75,7 @@ bool QWidgetEventManager::handleMouseEvent( QMouseEvent *event )
   QPoint widget_pos = event->pos() / scale_;
   bool is_mouse_down = ( event->buttons() & Qt::LeftButton ) == Qt::LeftButton;
   if ( mouse_down_widget_ ) {
-    QPoint local_pos = mouse_down_widget_->mapFrom( widget_, widget_pos );
+    QPoint local_pos = hit_test_cache_->mapFromRoot( mouse_down_widget_, widget_pos );
 
     QMouseEvent child_mouse_event( event->type(), local_pos, event->screenPos(), event->button(),
                                    event->buttons(), event->modifiers() );
@@ -84,16 +89,17 @@ bool QWidgetEventManager::handleMouseEvent( QMouseEvent *event )
     return true;
   }
 
-  QWidget *child = widget_->childAt( widget_pos );
+  // The cache also provides the position relative to the child, hence, no need to map it
+  QPoint local_pos;
+  QWidget *child = hit_test_cache_->childAt( widget_pos, &local_pos );
   if ( child == nullptr ) {
     sendHoverEvents( nullptr, widget_pos, event );
     return false;
   }
 
   // Now forward the event to the child with the position of the mouse relative to the child widget
-  QMouseEvent child_mouse_event( event->type(), child->mapFrom( widget_, widget_pos ),
-                                 event->screenPos(), event->button(), event->buttons(),
-                                 event->modifiers() );
+  QMouseEvent child_mouse_event( event->type(), local_pos, event->screenPos(), event->button(),
+                                 event->buttons(), event->modifiers() );
 
   bool handled = QApplication::sendEvent( child, &child_mouse_event );
   if ( !handled || !child_mouse_event.isAccepted() ) {
@@ -117,14 +123,13 @@ bool QWidgetEventManager::handleWheelEvent( QWheelEvent *event )
 {
   // Map the wheel event to the render panel because the top left of the render panel is equivalent to
   // the top left of the widget. Using the widget to map does not work because Qt doesn't know where the widget is drawn.
-  QPointF local_pos = event->position() / scale_;
-  QWidget *child = widget_->childAt( local_pos.toPoint() );
+  QPoint local_pos;
+  QWidget *child = hit_test_cache_->childAt( ( event->position() / scale_ ).toPoint(), &local_pos );
   if ( child == nullptr ) {
     return false;
   }
 
   // Now forward the event to the child with the position of the mouse relative to the child widget
-  local_pos = child->mapFrom( widget_, local_pos.toPoint() );
   QWheelEvent child_event( local_pos, event->globalPosition(), event->pixelDelta(),
                            event->angleDelta(), event->buttons(), event->modifiers(),
                            event->phase(), event->source() );
@@ -160,7 +165,8 @@ bool QWidgetEventManager::handleKeyEvent( QKeyEvent *event )
 
 void QWidgetEventManager::sendHoverEvents( QWidget *child, QPoint pos, QMouseEvent *event )
 {
-  // If mouse over widget changed, send enter/leave events
+  // If mouse over widget changed, send enter/leave events. Otherwise, this is a no-op, hence,
+  // hovering the same widget only costs the cached hit-test.
   if ( mouse_over_widget_ != child ) {
     QWidgetList enter_list;
     QWidgetList leave_list;
@@ -212,7 +218,7 @@ void QWidgetEventManager::sendHoverEvents( QWidget *child, QPoint pos, QMouseEve
     // Send the enter event to all widgets that were determined
     for ( int k = 0; k < enter_list.size(); ++k ) {
       QWidget *w = enter_list.at( k );
-      QPoint local_pos = w->mapFrom( widget_, pos );
+      QPoint local_pos = hit_test_cache_->mapFromRoot( w, pos );
       QEnterEvent enter_event( local_pos, event->windowPos(), event->screenPos() );
       QApplication::sendEvent( w, &enter_event );
       // If the widget has the hover attribute, send it a HoverEnter event as well
@@ -0,0 +1,168 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/events/widget_hit_test_cache.hpp"
+
+#include <QEvent>
+#include <QWidget>
+
+#include <algorithm>
+
+namespace hector_rviz_overlay
+{
+
+WidgetHitTestCache::WidgetHitTestCache( QWidget *root ) : root_( root )
+{
+  root_->installEventFilter( this );
+}
+
+WidgetHitTestCache::~WidgetHitTestCache() = default;
+
+void WidgetHitTestCache::invalidate() { outdated_ = true; }
+
+bool WidgetHitTestCache::eventFilter( QObject *watched, QEvent *event )
+{
+  switch ( event->type() ) {
+  case QEvent::Move:
+  case QEvent::Resize:
+  case QEvent::Show:
+  case QEvent::Hide:
+  case QEvent::ShowToParent:
+  case QEvent::HideToParent:
+  case QEvent::ChildAdded:
+  case QEvent::ChildRemoved:
+  case QEvent::ZOrderChange:
+  case QEvent::ParentChange:
+    outdated_ = true;
+    break;
+  default:
+    break;
+  }
+  return QObject::eventFilter( watched, event );
+}
+
+void WidgetHitTestCache::ensureUpToDate()
+{
+  if ( !outdated_ && root_->size() != root_size_ )
+    outdated_ = true;
+  for ( size_t i = 0; i < geometries_.size() && !outdated_; ++i ) {
+    const auto &geometry = geometries_[i];
+    if ( geometry.first == nullptr || geometry.first->geometry() != geometry.second )
+      outdated_ = true;
+  }
+  if ( outdated_ )
+    rebuild();
+}
+
+QWidget *WidgetHitTestCache::childAt( const QPoint &pos, QPoint *local_pos )
+{
+  ensureUpToDate();
+  QWidget *result = nullptr;
+  if ( has_masks_ ) {
+    result = root_->childAt( pos );
+  } else if ( pos.x() >= 0 && pos.y() >= 0 && pos.x() < columns_ * CellSize &&
+              pos.y() < rows_ * CellSize ) {
+    const std::vector<unsigned> &cell = cells_[( pos.y() / CellSize ) * columns_ + pos.x() / CellSize];
+    for ( unsigned index : cell ) {
+      const Entry &entry = entries_[index];
+      if ( !entry.rect.contains( pos ) )
+        continue;
+      if ( entry.widget == nullptr ) {
+        // Deleted without us noticing, e.g., deleteLater before the ChildRemoved was processed
+        outdated_ = true;
+        result = root_->childAt( pos );
+        break;
+      }
+      result = entry.widget;
+      break;
+    }
+  }
+  if ( result != nullptr && local_pos != nullptr )
+    *local_pos = mapFromRoot( result, pos );
+  return result;
+}
+
+QPoint WidgetHitTestCache::mapFromRoot( QWidget *widget, const QPoint &pos )
+{
+  ensureUpToDate();
+  auto it = entry_indices_.find( widget );
+  if ( it != entry_indices_.end() )
+    return pos - entries_[it->second].offset;
+  return widget->mapFrom( root_, pos );
+}
+
+void WidgetHitTestCache::rebuild()
+{
+  outdated_ = false;
+  has_masks_ = false;
+  entries_.clear();
+  entry_indices_.clear();
+  geometries_.clear();
+  root_size_ = root_->size();
+  collect( root_, QPoint( 0, 0 ), root_->rect() );
+
+  columns_ = ( root_->width() + CellSize - 1 ) / CellSize;
+  rows_ = ( root_->height() + CellSize - 1 ) / CellSize;
+  cells_.assign( columns_ * rows_, {} );
+  std::vector<bool> covered( cells_.size(), false );
+  // Entries are in paint order, hence, iterate in reverse to insert the topmost entries first
+  for ( size_t i = entries_.size(); i-- > 0; ) {
+    const QRect &rect = entries_[i].rect;
+    int first_column = std::max( 0, rect.left() / CellSize );
+    int last_column = std::min( columns_ - 1, rect.right() / CellSize );
+    int first_row = std::max( 0, rect.top() / CellSize );
+    int last_row = std::min( rows_ - 1, rect.bottom() / CellSize );
+    for ( int row = first_row; row <= last_row; ++row ) {
+      for ( int column = first_column; column <= last_column; ++column ) {
+        size_t cell_index = row * columns_ + column;
+        if ( covered[cell_index] )
+          continue;
+        cells_[cell_index].push_back( static_cast<unsigned>( i ) );
+        QRect cell_rect( column * CellSize, row * CellSize, CellSize, CellSize );
+        if ( rect.contains( cell_rect & root_->rect() ) )
+          covered[cell_index] = true;
+      }
+    }
+  }
+}
+
+void WidgetHitTestCache::collect( QWidget *parent, const QPoint &offset, const QRect &clip )
+{
+  // Children are ordered from bottom to top, the same order that is used by QWidget::childAt
+  for ( QObject *object : parent->children() ) {
+    if ( !object->isWidgetType() )
+      continue;
+    auto *child = static_cast<QWidget *>( object );
+    if ( child->isWindow() )
+      continue;
+    // Watch hidden children as well to notice when they are shown
+    child->installEventFilter( this );
+    geometries_.emplace_back( child, child->geometry() );
+    if ( child->isHidden() || child->testAttribute( Qt::WA_TransparentForMouseEvents ) )
+      continue;
+    if ( !child->mask().isEmpty() )
+      has_masks_ = true;
+    QPoint child_offset = offset + child->pos();
+    QRect rect = QRect( child_offset, child->size() ) & clip;
+    if ( rect.isEmpty() )
+      continue;
+    entry_indices_.emplace( child, entries_.size() );
+    entries_.push_back( { child, rect, child_offset } );
+    collect( child, child_offset, rect );
+  }
+}
+} // namespace hector_rviz_overlay
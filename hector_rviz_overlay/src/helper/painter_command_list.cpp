@@ -0,0 +1,363 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/helper/painter_command_list.hpp"
+
+#include <QPainter>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hector_rviz_overlay
+{
+
+enum class PainterCommandList::CommandType : uint16_t {
+  SetPen,
+  SetBrush,
+  SetFont,
+  SetOpacity,
+  Save,
+  Restore,
+  Translate,
+  Rotate,
+  Scale,
+  DrawLine,
+  DrawRect,
+  DrawEllipse,
+  DrawArc,
+  DrawPolyline,
+  DrawPolygon,
+  DrawTextAt,
+  DrawTextInRect
+};
+
+namespace
+{
+// All entries are padded to a multiple of this alignment, so that the points and characters stored
+// in the arena can be passed to the QPainter without copying.
+constexpr size_t EntryAlignment = 8;
+
+constexpr size_t alignUp( size_t size )
+{
+  return ( size + EntryAlignment - 1 ) & ~( EntryAlignment - 1 );
+}
+
+struct CommandHeader {
+  uint16_t type;
+  uint16_t reserved;
+  //! The size of the payload and the extra data including the padding.
+  uint32_t size;
+};
+static_assert( sizeof( CommandHeader ) == EntryAlignment, "Header has to keep the alignment." );
+
+struct PenPayload {
+  QRgb color;
+  int32_t style;
+  double width;
+};
+
+struct BrushPayload {
+  QRgb color;
+};
+
+struct FontPayload {
+  int32_t pixel_size;
+  int32_t bold;
+};
+
+struct ScalarPayload {
+  double a;
+  double b;
+};
+
+struct LinePayload {
+  double x1, y1, x2, y2;
+};
+
+struct RectPayload {
+  double x, y, width, height;
+};
+
+struct ArcPayload {
+  RectPayload rect;
+  //! In 1/16th of a degree as expected by QPainter.
+  int32_t start_angle;
+  int32_t span_angle;
+};
+
+struct PointsPayload {
+  int32_t count;
+};
+
+struct TextPayload {
+  RectPayload rect;
+  int32_t flags;
+  int32_t length;
+};
+
+template<typename T>
+T readPayload( const unsigned char *data )
+{
+  T result;
+  std::memcpy( &result, data, sizeof( T ) );
+  return result;
+}
+
+QRectF toRect( const RectPayload &rect ) { return { rect.x, rect.y, rect.width, rect.height }; }
+
+RectPayload fromRect( const QRectF &rect )
+{
+  return { rect.x(), rect.y(), rect.width(), rect.height() };
+}
+} // namespace
+
+void PainterCommandList::clear()
+{
+  // Keeps the capacity, see the standard's requirements for vector::clear
+  data_.clear();
+  command_count_ = 0;
+}
+
+void PainterCommandList::append( CommandType type, const void *payload, size_t payload_size,
+                                 const void *extra, size_t extra_size )
+{
+  const size_t payload_offset = alignUp( payload_size );
+  CommandHeader header{};
+  header.type = static_cast<uint16_t>( type );
+  header.size = static_cast<uint32_t>( payload_offset + alignUp( extra_size ) );
+
+  const size_t offset = data_.size();
+  data_.resize( offset + sizeof( CommandHeader ) + header.size );
+  unsigned char *entry = data_.data() + offset;
+  std::memcpy( entry, &header, sizeof( CommandHeader ) );
+  entry += sizeof( CommandHeader );
+  if ( payload_size != 0 )
+    std::memcpy( entry, payload, payload_size );
+  if ( extra_size != 0 )
+    std::memcpy( entry + payload_offset, extra, extra_size );
+  ++command_count_;
+}
+
+void PainterCommandList::setPen( const QColor &color, qreal width, Qt::PenStyle style )
+{
+  PenPayload payload{ color.rgba(), static_cast<int32_t>( style ), width };
+  append( CommandType::SetPen, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::setBrush( const QColor &color )
+{
+  BrushPayload payload{ color.rgba() };
+  append( CommandType::SetBrush, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::setFont( int pixel_size, bool bold )
+{
+  FontPayload payload{ pixel_size, bold ? 1 : 0 };
+  append( CommandType::SetFont, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::setOpacity( qreal opacity )
+{
+  ScalarPayload payload{ opacity, 0 };
+  append( CommandType::SetOpacity, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::save() { append( CommandType::Save, nullptr, 0 ); }
+
+void PainterCommandList::restore() { append( CommandType::Restore, nullptr, 0 ); }
+
+void PainterCommandList::translate( qreal dx, qreal dy )
+{
+  ScalarPayload payload{ dx, dy };
+  append( CommandType::Translate, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::rotate( qreal degrees )
+{
+  ScalarPayload payload{ degrees, 0 };
+  append( CommandType::Rotate, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::scale( qreal sx, qreal sy )
+{
+  ScalarPayload payload{ sx, sy };
+  append( CommandType::Scale, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::drawLine( const QPointF &p1, const QPointF &p2 )
+{
+  LinePayload payload{ p1.x(), p1.y(), p2.x(), p2.y() };
+  append( CommandType::DrawLine, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::drawRect( const QRectF &rect )
+{
+  RectPayload payload = fromRect( rect );
+  append( CommandType::DrawRect, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::drawEllipse( const QPointF &center, qreal rx, qreal ry )
+{
+  RectPayload payload{ center.x() - rx, center.y() - ry, 2 * rx, 2 * ry };
+  append( CommandType::DrawEllipse, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::drawArc( const QRectF &rect, qreal start_angle, qreal span_angle )
+{
+  ArcPayload payload{ fromRect( rect ), qRound( start_angle * 16 ), qRound( span_angle * 16 ) };
+  append( CommandType::DrawArc, &payload, sizeof( payload ) );
+}
+
+void PainterCommandList::drawPolyline( const QPointF *points, int count )
+{
+  if ( count <= 0 )
+    return;
+  PointsPayload payload{ count };
+  append( CommandType::DrawPolyline, &payload, sizeof( payload ), points,
+          count * sizeof( QPointF ) );
+}
+
+void PainterCommandList::drawPolygon( const QPointF *points, int count )
+{
+  if ( count <= 0 )
+    return;
+  PointsPayload payload{ count };
+  append( CommandType::DrawPolygon, &payload, sizeof( payload ), points,
+          count * sizeof( QPointF ) );
+}
+
+void PainterCommandList::drawText( const QPointF &position, const QString &text )
+{
+  if ( text.isEmpty() )
+    return;
+  TextPayload payload{ { position.x(), position.y(), 0, 0 }, 0, text.size() };
+  append( CommandType::DrawTextAt, &payload, sizeof( payload ), text.constData(),
+          text.size() * sizeof( QChar ) );
+}
+
+void PainterCommandList::drawText( const QRectF &rect, int flags, const QString &text )
+{
+  if ( text.isEmpty() )
+    return;
+  TextPayload payload{ fromRect( rect ), flags, text.size() };
+  append( CommandType::DrawTextInRect, &payload, sizeof( payload ), text.constData(),
+          text.size() * sizeof( QChar ) );
+}
+
+void PainterCommandList::replay( QPainter &painter ) const
+{
+  const unsigned char *data = data_.data();
+  size_t offset = 0;
+  while ( offset < data_.size() ) {
+    const auto header = readPayload<CommandHeader>( data + offset );
+    const unsigned char *payload = data + offset + sizeof( CommandHeader );
+    offset += sizeof( CommandHeader ) + header.size;
+    switch ( static_cast<CommandType>( header.type ) ) {
+    case CommandType::SetPen: {
+      const auto pen = readPayload<PenPayload>( payload );
+      if ( qAlpha( pen.color ) == 0 ) {
+        painter.setPen( Qt::NoPen );
+        break;
+      }
+      QPen qpen( QColor::fromRgba( pen.color ) );
+      qpen.setWidthF( pen.width );
+      qpen.setStyle( static_cast<Qt::PenStyle>( pen.style ) );
+      painter.setPen( qpen );
+      break;
+    }
+    case CommandType::SetBrush: {
+      const auto brush = readPayload<BrushPayload>( payload );
+      if ( qAlpha( brush.color ) == 0 )
+        painter.setBrush( Qt::NoBrush );
+      else
+        painter.setBrush( QColor::fromRgba( brush.color ) );
+      break;
+    }
+    case CommandType::SetFont: {
+      const auto font_payload = readPayload<FontPayload>( payload );
+      QFont font = painter.font();
+      font.setPixelSize( std::max( 1, font_payload.pixel_size ) );
+      font.setBold( font_payload.bold != 0 );
+      painter.setFont( font );
+      break;
+    }
+    case CommandType::SetOpacity:
+      painter.setOpacity( readPayload<ScalarPayload>( payload ).a );
+      break;
+    case CommandType::Save:
+      painter.save();
+      break;
+    case CommandType::Restore:
+      painter.restore();
+      break;
+    case CommandType::Translate: {
+      const auto translation = readPayload<ScalarPayload>( payload );
+      painter.translate( translation.a, translation.b );
+      break;
+    }
+    case CommandType::Rotate:
+      painter.rotate( readPayload<ScalarPayload>( payload ).a );
+      break;
+    case CommandType::Scale: {
+      const auto scaling = readPayload<ScalarPayload>( payload );
+      painter.scale( scaling.a, scaling.b );
+      break;
+    }
+    case CommandType::DrawLine: {
+      const auto line = readPayload<LinePayload>( payload );
+      painter.drawLine( QPointF( line.x1, line.y1 ), QPointF( line.x2, line.y2 ) );
+      break;
+    }
+    case CommandType::DrawRect:
+      painter.drawRect( toRect( readPayload<RectPayload>( payload ) ) );
+      break;
+    case CommandType::DrawEllipse:
+      painter.drawEllipse( toRect( readPayload<RectPayload>( payload ) ) );
+      break;
+    case CommandType::DrawArc: {
+      const auto arc = readPayload<ArcPayload>( payload );
+      painter.drawArc( toRect( arc.rect ), arc.start_angle, arc.span_angle );
+      break;
+    }
+    case CommandType::DrawPolyline:
+    case CommandType::DrawPolygon: {
+      const auto points = readPayload<PointsPayload>( payload );
+      const auto *point_data =
+          reinterpret_cast<const QPointF *>( payload + alignUp( sizeof( PointsPayload ) ) );
+      if ( static_cast<CommandType>( header.type ) == CommandType::DrawPolyline )
+        painter.drawPolyline( point_data, points.count );
+      else
+        painter.drawPolygon( point_data, points.count );
+      break;
+    }
+    case CommandType::DrawTextAt:
+    case CommandType::DrawTextInRect: {
+      const auto text = readPayload<TextPayload>( payload );
+      const auto *characters =
+          reinterpret_cast<const QChar *>( payload + alignUp( sizeof( TextPayload ) ) );
+      // Does not copy the characters, the arena outlives the string
+      const QString string = QString::fromRawData( characters, text.length );
+      if ( static_cast<CommandType>( header.type ) == CommandType::DrawTextAt )
+        painter.drawText( QPointF( text.rect.x, text.rect.y ), string );
+      else
+        painter.drawText( toRect( text.rect ), text.flags, string );
+      break;
+    }
+    }
+  }
+}
+} // namespace hector_rviz_overlay
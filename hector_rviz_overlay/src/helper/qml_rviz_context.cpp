@@ -16,6 +16,7 @@
  */
 
 #include "hector_rviz_overlay/helper/qml_rviz_context.hpp"
+#include "hector_rviz_overlay/overlay_manager.hpp"
 #include "hector_rviz_overlay/positioning/ogre_position_tracker.hpp"
 
 #include <QWidget>
@@ -43,6 +44,8 @@ QmlRvizContext::QmlRvizContext( rviz_common::DisplayContext *context, const Over
   configuration_property_ = new Property( "Configuration", QVariant(),
                                           "Container for configurable settings of the overlay." );
   tool_manager_ = std::make_unique<QmlToolManager>( context_->getToolManager() );
+  connect( &OverlayManager::getSingleton(), &OverlayManager::powerStateChanged, this,
+           &QmlRvizContext::powerStateChanged );
   // If rviz is used as widget inside an application, the window manager interface may not be available
   rviz_common::WindowManagerInterface *wmi = context_->getWindowManager();
   QWindow *window = wmi == nullptr ? nullptr : wmi->getParentWindow()->windowHandle();
@@ -109,6 +112,23 @@ void QmlRvizContext::setFixedFrame( const QString &frame )
   context_->getFrameManager()->setFixedFrame( frame.toStdString() );
 }
 
+QString QmlRvizContext::powerState() const
+{
+  switch ( OverlayManager::getSingleton().powerState() ) {
+  case OverlayManager::PowerInactive:
+    return "inactive";
+  case OverlayManager::PowerMinimized:
+    return "minimized";
+  default:
+    return "active";
+  }
+}
+
+bool QmlRvizContext::lowPower() const
+{
+  return OverlayManager::getSingleton().powerState() != OverlayManager::PowerActive;
+}
+
 void QmlRvizContext::onWindowStateChanged( Qt::WindowState state )
 {
   if ( ( state & Qt::WindowFullScreen ) != ( window_state_ & Qt::WindowFullScreen ) )
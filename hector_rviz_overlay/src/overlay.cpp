@@ -17,6 +17,8 @@
 
 #include "hector_rviz_overlay/overlay.hpp"
 
+#include "hector_rviz_overlay/helper/mpsc_queue.hpp"
+
 namespace hector_rviz_overlay
 {
 
@@ -25,7 +27,16 @@ Overlay::Overlay( std::string name ) : name_( std::move( name ) )
   qRegisterMetaType<hector_rviz_overlay::OverlayPtr>();
 }
 
-Overlay::~Overlay() = default;
+Overlay::~Overlay() { delete update_queue_.load( std::memory_order_acquire ); }
+
+void Overlay::setName( const std::string &value )
+{
+  if ( value == name_ )
+    return;
+  std::string old_name = std::move( name_ );
+  name_ = value;
+  emit nameChanged( old_name );
+}
 
 void Overlay::setGeometry( const QRect &value )
 {
@@ -46,11 +57,50 @@ void Overlay::setIsVisible( bool value )
   requestRender();
 }
 
-void Overlay::requestRender() { is_dirty_ = true; }
+void Overlay::setHiddenPolicy( HiddenPolicy value )
+{
+  if ( value == hidden_policy_ )
+    return;
+  hidden_policy_ = value;
+  emit hiddenPolicyChanged();
+}
+
+void Overlay::requestRender() { is_dirty_.store( true, std::memory_order_release ); }
+
+bool Overlay::queueUpdate( UpdateFunction update )
+{
+  MpscQueue<UpdateFunction> *queue = update_queue_.load( std::memory_order_acquire );
+  if ( queue == nullptr ) {
+    // Most overlays never queue updates, hence, the queue is only allocated on first use.
+    // If multiple threads race here, all but one discard their queue.
+    auto *new_queue = new MpscQueue<UpdateFunction>( UpdateQueueCapacity );
+    if ( update_queue_.compare_exchange_strong( queue, new_queue, std::memory_order_acq_rel ) )
+      queue = new_queue;
+    else
+      delete new_queue;
+  }
+  if ( !queue->tryPush( std::move( update ) ) )
+    return false;
+  requestRender();
+  return true;
+}
+
+void Overlay::processQueuedUpdates()
+{
+  MpscQueue<UpdateFunction> *queue = update_queue_.load( std::memory_order_acquire );
+  if ( queue == nullptr )
+    return;
+  UpdateFunction update;
+  // Limit to the capacity to make sure producers can't keep the render thread busy indefinitely
+  for ( size_t i = 0; i < queue->capacity() && queue->tryPop( update ); ++i ) {
+    update();
+  }
+}
 
 void Overlay::render( Renderer *renderer )
 {
-  is_dirty_ = false;
+  // Cleared before rendering, so that requests during the render are not lost
+  is_dirty_.store( false, std::memory_order_release );
   renderImpl( renderer );
 }
 } // namespace hector_rviz_overlay
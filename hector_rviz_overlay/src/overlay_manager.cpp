@@ -16,18 +16,25 @@
  */
 
 #include "hector_rviz_overlay/overlay_manager.hpp"
+#include "hector_rviz_overlay/events/input_recorder.hpp"
+#include "hector_rviz_overlay/render/frame_animation_driver.hpp"
 #include "hector_rviz_overlay/render/overlay_renderer.hpp"
 
 #include <QApplication>
+#include <QFocusEvent>
 #include <QMouseEvent>
 #include <QPainter>
 #include <QTimer>
+#include <QWindow>
 
 #include <Ogre.h>
 
+#include <algorithm>
+
 #include <rviz_common/display_context.hpp>
 #include <rviz_common/render_panel.hpp>
 #include <rviz_common/view_manager.hpp>
+#include <rviz_common/window_manager_interface.hpp>
 
 #include "logging.hpp"
 
@@ -44,6 +51,9 @@ OverlayManager::OverlayManager()
     : context_( nullptr ), render_panel_( nullptr ), renderer_( nullptr ),
       mouse_overlay_( nullptr ), mouse_down_overlay_( nullptr ), focused_overlay_( nullptr )
 {
+  idle_teardown_timer_.setSingleShot( true );
+  idle_teardown_timer_.setInterval( 10000 );
+  connect( &idle_teardown_timer_, &QTimer::timeout, this, &OverlayManager::onIdleTeardownTimeout );
 }
 
 OverlayManager::~OverlayManager() = default;
@@ -59,14 +69,61 @@ void OverlayManager::init( rviz_common::DisplayContext *context )
   render_panel_ = context_->getViewManager()->getRenderPanel();
   connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
            &OverlayManager::onAboutToQuit, Qt::DirectConnection );
+
+  // Allows to record the input for benchmarking the event handling using the InputReplayer
+  QString input_trace_path = qEnvironmentVariable( "HECTOR_RVIZ_OVERLAY_RECORD_INPUT" );
+  if ( !input_trace_path.isEmpty() && input_recorder_ == nullptr ) {
+    LOG_WARN( "!!! HECTOR_RVIZ_OVERLAY_RECORD_INPUT is set: All key events reaching the overlays, "
+              "including passwords typed into them, are recorded unencrypted to '%s'. Unset it "
+              "unless you are benchmarking the event handling. !!!",
+              input_trace_path.toStdString().c_str() );
+    input_recorder_ = std::make_unique<InputRecorder>( render_panel_ );
+    input_recorder_->start( input_trace_path );
+  }
+
+  // init is called again if the renderer was destroyed in between, hence, unique connections
+  connect( qApp, &QGuiApplication::applicationStateChanged, this,
+           &OverlayManager::updatePowerState, Qt::UniqueConnection );
+  rviz_common::WindowManagerInterface *wmi = context_->getWindowManager();
+  if ( wmi != nullptr && wmi->getParentWindow() != nullptr )
+    main_window_ = wmi->getParentWindow()->windowHandle();
+  if ( main_window_ != nullptr ) {
+    connect( main_window_, &QWindow::windowStateChanged, this, &OverlayManager::updatePowerState,
+             Qt::UniqueConnection );
+    // Exposure changes are caught in the event filter
+  }
+  updatePowerState();
+}
+
+void OverlayManager::initHeadless( QWidget *render_panel, RendererFactory renderer_factory )
+{
+  if ( renderer_ != nullptr )
+    return;
+
+  context_ = nullptr;
+  render_panel_ = render_panel;
+  renderer_factory_ = std::move( renderer_factory );
+  connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+           &OverlayManager::onAboutToQuit,
+           static_cast<Qt::ConnectionType>( Qt::DirectConnection | Qt::UniqueConnection ) );
+  connect( qApp, &QGuiApplication::applicationStateChanged, this,
+           &OverlayManager::updatePowerState, Qt::UniqueConnection );
+  updatePowerState();
 }
 
 void OverlayManager::onAboutToQuit()
 {
   qApp->removeEventFilter( this );
+  idle_teardown_timer_.stop();
+  input_recorder_.reset();
+  // Has to be released at this point because, e.g., the GLXOverlayRenderer requires its pointer to the RenderPanel to be valid
+  destroyRenderer();
+}
+
+void OverlayManager::destroyRenderer()
+{
   if ( renderer_ == nullptr )
     return;
-  // Has to be released at this point because, e.g., the GLXOverlayRenderer requires its pointer to the RenderPanel to be valid
   renderer_->releaseResources();
   delete renderer_;
   renderer_ = nullptr;
@@ -82,26 +139,42 @@ bool OverlayManager::addOverlay( OverlayPtr overlay, bool unique_name_if_exists
     if ( !unique_name_if_exists ) {
       return false;
     }
-    int counter = 1;
+    // Start at the last suffix used for this name to avoid probing all previously generated names
+    int &counter = next_name_suffix_[overlay->name()];
+    if ( counter < 1 )
+      counter = 1;
     while ( getByName( overlay->name() + std::to_string( counter ) ) != nullptr ) counter++;
     overlay->setName( overlay->name() + std::to_string( counter ) );
   }
 
+  // The renderer may still be alive if the last overlay was removed recently
+  idle_teardown_timer_.stop();
   if ( renderer_ == nullptr ) {
-    renderer_ = OverlayRenderer::create( context_ );
-    qApp->installEventFilter( this );
+    renderer_ = renderer_factory_ ? renderer_factory_() : OverlayRenderer::create( context_ );
+    renderer_->setFrameTimeBudget( frame_time_budget_ms_ );
+    renderer_->setWarmUpEnabled( warm_up_enabled_ );
+    applyPowerPolicy();
+    applyResolutionPolicy();
   }
+  if ( ui_overlays_.empty() && popup_overlays_.empty() )
+    qApp->installEventFilter( this );
 
   UiOverlayPtr ui_overlay = std::dynamic_pointer_cast<UiOverlay>( overlay );
   if ( ui_overlay != nullptr ) {
+    std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
     insertOverlay( ui_overlay );
+    overlays_by_name_.emplace( overlay->name(), overlay );
+    connect( overlay.get(), &Overlay::nameChanged, this, &OverlayManager::onOverlayNameChanged );
 
     connect( ui_overlay.get(), &UiOverlay::zIndexChanged, this, &OverlayManager::onZIndexChanged );
     return true;
   }
   PopupOverlayPtr popup_overlay = std::dynamic_pointer_cast<PopupOverlay>( overlay );
   if ( popup_overlay != nullptr ) {
+    std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
     popup_overlays_.push_back( popup_overlay );
+    overlays_by_name_.emplace( overlay->name(), overlay );
+    connect( overlay.get(), &Overlay::nameChanged, this, &OverlayManager::onOverlayNameChanged );
     renderer_->addOverlay( overlay );
     return true;
   }
@@ -116,18 +189,71 @@ bool OverlayManager::removeOverlay( const std::string &name )
 
 void OverlayManager::checkEmpty()
 {
-  // If there are no overlays left, the renderer is destroyed.
+  // If there are no overlays left, the renderer is destroyed after the idle teardown timeout.
   // This is done for two reasons: The first and most obvious, we don't need a renderer if we have
   // no overlays and second, when deleting it in OverlayManager's destructor it crashes because of a
   // multithreading issue and deleting when the RenderPanel is destroyed doesn't work either because
   // the overlays are removed after that which leads to a different crash.
-  if ( ui_overlays_.empty() && popup_overlays_.empty() ) {
-    qApp->removeEventFilter( this );
-    if ( renderer_ != nullptr ) {
-      renderer_->releaseResources();
-      delete renderer_;
-      renderer_ = nullptr;
-    }
+  // If the application quits before the timeout, the renderer is destroyed in onAboutToQuit.
+  // During a transaction, this is deferred to the commit since overlays may be added again.
+  if ( transaction_depth_ > 0 )
+    return;
+  if ( !ui_overlays_.empty() || !popup_overlays_.empty() )
+    return;
+  qApp->removeEventFilter( this );
+  if ( renderer_ == nullptr )
+    return;
+  if ( idle_teardown_timer_.interval() <= 0 ) {
+    destroyRenderer();
+    return;
+  }
+  idle_teardown_timer_.start();
+}
+
+void OverlayManager::onIdleTeardownTimeout()
+{
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  if ( !ui_overlays_.empty() || !popup_overlays_.empty() )
+    return;
+  destroyRenderer();
+}
+
+int OverlayManager::idleTeardownTimeout() const { return idle_teardown_timer_.interval(); }
+
+void OverlayManager::setIdleTeardownTimeout( int value )
+{
+  idle_teardown_timer_.setInterval( std::max( 0, value ) );
+  // Apply the new timeout to a pending teardown
+  if ( idle_teardown_timer_.isActive() )
+    idle_teardown_timer_.start();
+}
+
+namespace
+{
+//! @return Whether name is base or base followed by a suffix generated in addOverlay.
+bool isNameWithSuffix( const std::string &name, const std::string &base )
+{
+  if ( name.compare( 0, base.size(), base ) != 0 )
+    return false;
+  return std::all_of( name.begin() + static_cast<std::ptrdiff_t>( base.size() ), name.end(),
+                      []( char c ) { return c >= '0' && c <= '9'; } );
+}
+} // namespace
+
+void OverlayManager::pruneNameSuffixes( const std::string &name )
+{
+  const auto has_overlay_with_base = [this]( const std::string &base ) {
+    const auto matches = [&base]( const auto &overlay ) {
+      return isNameWithSuffix( overlay->name(), base );
+    };
+    return std::any_of( ui_overlays_.begin(), ui_overlays_.end(), matches ) ||
+           std::any_of( popup_overlays_.begin(), popup_overlays_.end(), matches );
+  };
+  for ( auto it = next_name_suffix_.begin(); it != next_name_suffix_.end(); ) {
+    if ( isNameWithSuffix( name, it->first ) && !has_overlay_with_base( it->first ) )
+      it = next_name_suffix_.erase( it );
+    else
+      ++it;
   }
 }
 
@@ -147,9 +273,20 @@ bool OverlayManager::removeOverlay( OverlayPtr overlay )
 
   if ( overlay == focused_overlay_ ) {
     overlay->handleEventsCanceled();
-    focused_overlay_ = nullptr;
+    setFocusedOverlay( nullptr );
   }
 
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  auto name_it = overlays_by_name_.find( overlay->name() );
+  if ( name_it == overlays_by_name_.end() || name_it->second != overlay ) {
+    // Not indexed under its name, e.g., because it was renamed to the name of another overlay
+    name_it = std::find_if( overlays_by_name_.begin(), overlays_by_name_.end(),
+                            [&overlay]( const auto &entry ) { return entry.second == overlay; } );
+  }
+  if ( name_it != overlays_by_name_.end() )
+    overlays_by_name_.erase( name_it );
+  disconnect( overlay.get(), &Overlay::nameChanged, this, &OverlayManager::onOverlayNameChanged );
+
   for ( auto it = ui_overlays_.begin(); it != ui_overlays_.end(); ++it ) {
     if ( *it != overlay ) {
       continue;
@@ -162,6 +299,7 @@ bool OverlayManager::removeOverlay( OverlayPtr overlay )
     disconnect( static_cast<UiOverlay *>( overlay.get() ), &UiOverlay::zIndexChanged, this,
                 &OverlayManager::onZIndexChanged );
     ui_overlays_.erase( it );
+    pruneNameSuffixes( overlay->name() );
 
     checkEmpty();
     return true;
@@ -176,6 +314,7 @@ bool OverlayManager::removeOverlay( OverlayPtr overlay )
       renderer_->removeOverlay( overlay );
     }
     popup_overlays_.erase( it );
+    pruneNameSuffixes( overlay->name() );
 
     checkEmpty();
     return true;
@@ -186,33 +325,42 @@ bool OverlayManager::removeOverlay( OverlayPtr overlay )
 OverlayPtr OverlayManager::getByName( const std::string &name )
 {
   std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
-  for ( UiOverlayPtr &overlay : ui_overlays_ ) {
-    if ( overlay->name() == name )
-      return overlay;
-  }
-  for ( PopupOverlayPtr &overlay : popup_overlays_ ) {
-    if ( overlay->name() == name )
-      return overlay;
-  }
-  return nullptr;
+  auto it = overlays_by_name_.find( name );
+  return it == overlays_by_name_.end() ? nullptr : it->second;
 }
 
 OverlayConstPtr OverlayManager::getByName( const std::string &name ) const
 {
   std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
-  for ( const UiOverlayPtr &overlay : ui_overlays_ ) {
-    if ( overlay->name() == name )
-      return overlay;
-  }
-  for ( const PopupOverlayPtr &overlay : popup_overlays_ ) {
-    if ( overlay->name() == name )
-      return overlay;
+  auto it = overlays_by_name_.find( name );
+  return it == overlays_by_name_.end() ? nullptr : it->second;
+}
+
+void OverlayManager::onOverlayNameChanged( const std::string &old_name )
+{
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  auto overlay = static_cast<Overlay *>( QObject::sender() );
+  auto it = overlays_by_name_.find( old_name );
+  if ( it == overlays_by_name_.end() || it->second.get() != overlay ) {
+    it = std::find_if( overlays_by_name_.begin(), overlays_by_name_.end(),
+                       [overlay]( const auto &entry ) { return entry.second.get() == overlay; } );
+    if ( it == overlays_by_name_.end() )
+      return;
   }
-  return nullptr;
+  OverlayPtr overlay_ptr = it->second;
+  overlays_by_name_.erase( it );
+  // If the new name is taken, the overlay can only be found by pointer, e.g., in removeOverlay
+  overlays_by_name_.emplace( overlay_ptr->name(), overlay_ptr );
+  pruneNameSuffixes( old_name );
 }
 
 void OverlayManager::onZIndexChanged()
 {
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  if ( transaction_depth_ > 0 ) {
+    order_outdated_ = true;
+    return;
+  }
   auto overlay = static_cast<UiOverlay *>( QObject::sender() );
   auto element = std::find_if( ui_overlays_.begin(), ui_overlays_.end(),
                                [=]( const OverlayPtr &x ) { return x.get() == overlay; } );
@@ -269,27 +417,160 @@ void OverlayManager::insertOverlay( UiOverlayPtr overlay )
 {
   OverlayPtr overlay_ptr = std::static_pointer_cast<Overlay>( overlay );
   std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
-  int i = 0;
-  for ( auto it = ui_overlays_.begin(); it != ui_overlays_.end(); ++it, ++i ) {
-    if ( ( *it )->zIndex() <= overlay->zIndex() )
-      continue;
-
-    ui_overlays_.insert( it, overlay );
-    renderer_->insertOverlay( overlay_ptr, i );
+  if ( transaction_depth_ > 0 ) {
+    // Sorted once when the transaction is committed
+    ui_overlays_.push_back( overlay );
+    renderer_->addOverlay( overlay_ptr );
+    order_outdated_ = true;
     return;
   }
-  ui_overlays_.push_back( overlay );
-  if ( popup_overlays_.empty() ) {
+  // Insert after all overlays with the same z-index
+  auto it = std::upper_bound(
+      ui_overlays_.begin(), ui_overlays_.end(), overlay->zIndex(),
+      []( int z_index, const UiOverlayPtr &other ) { return z_index < other->zIndex(); } );
+  size_t index = it - ui_overlays_.begin();
+  ui_overlays_.insert( it, overlay );
+  if ( index + 1 == ui_overlays_.size() && popup_overlays_.empty() ) {
     renderer_->addOverlay( overlay_ptr );
   } else {
-    renderer_->insertOverlay( overlay_ptr, i );
+    renderer_->insertOverlay( overlay_ptr, index );
+  }
+}
+
+void OverlayManager::beginTransaction()
+{
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  ++transaction_depth_;
+}
+
+void OverlayManager::commitTransaction()
+{
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  if ( transaction_depth_ == 0 ) {
+    LOG_WARN( "OverlayManager: commitTransaction called without matching beginTransaction!" );
+    return;
   }
+  if ( --transaction_depth_ > 0 )
+    return;
+  if ( order_outdated_ )
+    applyOrder();
+  checkEmpty();
+}
+
+double OverlayManager::frameTimeBudget() const { return frame_time_budget_ms_; }
+
+void OverlayManager::setFrameTimeBudget( double value )
+{
+  frame_time_budget_ms_ = std::max( 0.0, value );
+  if ( renderer_ != nullptr )
+    renderer_->setFrameTimeBudget( frame_time_budget_ms_ );
+}
+
+bool OverlayManager::warmUpEnabled() const { return warm_up_enabled_; }
+
+void OverlayManager::setWarmUpEnabled( bool value )
+{
+  warm_up_enabled_ = value;
+  if ( renderer_ != nullptr )
+    renderer_->setWarmUpEnabled( warm_up_enabled_ );
+}
+
+OverlayRenderStats OverlayManager::renderStats( const std::string &name ) const
+{
+  std::unique_lock<std::recursive_mutex> scoped_lock( mutex_ );
+  OverlayConstPtr overlay = getByName( name );
+  if ( overlay == nullptr || renderer_ == nullptr )
+    return {};
+  return renderer_->renderStats( overlay.get() );
+}
+
+OverlayManager::PowerState OverlayManager::powerState() const { return power_state_; }
+
+const OverlayManager::PowerPolicy &OverlayManager::powerPolicy() const { return power_policy_; }
+
+void OverlayManager::setPowerPolicy( const PowerPolicy &value )
+{
+  power_policy_ = value;
+  applyPowerPolicy();
+}
+
+const OverlayManager::ResolutionPolicy &OverlayManager::resolutionPolicy() const
+{
+  return resolution_policy_;
+}
+
+void OverlayManager::setResolutionPolicy( const ResolutionPolicy &value )
+{
+  resolution_policy_ = value;
+  applyResolutionPolicy();
+}
+
+void OverlayManager::updatePowerState()
+{
+  PowerState state = PowerActive;
+  if ( main_window_ != nullptr && ( ( main_window_->windowStates() & Qt::WindowMinimized ) ||
+                                    ( main_window_->isVisible() && !main_window_->isExposed() ) ) )
+    state = PowerMinimized;
+  else if ( QGuiApplication::applicationState() != Qt::ApplicationActive )
+    state = PowerInactive;
+  if ( state == power_state_ )
+    return;
+  power_state_ = state;
+  applyPowerPolicy();
+  emit powerStateChanged( power_state_ );
+}
+
+void OverlayManager::applyPowerPolicy()
+{
+  bool throttled = power_policy_.enabled && power_state_ != PowerActive;
+  bool suspended = throttled && power_policy_.suspend_when_minimized &&
+                   power_state_ == PowerMinimized;
+  float max_update_rate = throttled ? power_policy_.inactive_max_update_rate : 0;
+  FrameAnimationDriver::setMaxTickRate( max_update_rate );
+  FrameAnimationDriver::setPaused( suspended );
+  if ( renderer_ == nullptr )
+    return;
+  renderer_->setGlobalMaxUpdateRate( max_update_rate );
+  renderer_->setSuspended( suspended );
+}
+
+void OverlayManager::applyResolutionPolicy()
+{
+  if ( renderer_ == nullptr )
+    return;
+  renderer_->setMinAdaptiveRenderResolution( resolution_policy_.min_resolution );
+  renderer_->setRenderResolution( resolution_policy_.resolution );
+  renderer_->setTargetRenderTime( resolution_policy_.target_render_time );
+  if ( renderer_->adaptiveRenderResolution() != resolution_policy_.adaptive )
+    renderer_->setAdaptiveRenderResolution( resolution_policy_.adaptive );
+}
+
+void OverlayManager::applyOrder()
+{
+  order_outdated_ = false;
+  std::stable_sort( ui_overlays_.begin(), ui_overlays_.end(),
+                    []( const UiOverlayPtr &a, const UiOverlayPtr &b ) {
+                      return a->zIndex() < b->zIndex();
+                    } );
+  if ( renderer_ == nullptr )
+    return;
+  // UI overlays are drawn first, popups on top
+  std::vector<OverlayPtr> order;
+  order.reserve( ui_overlays_.size() + popup_overlays_.size() );
+  order.insert( order.end(), ui_overlays_.begin(), ui_overlays_.end() );
+  order.insert( order.end(), popup_overlays_.begin(), popup_overlays_.end() );
+  renderer_->reorderOverlays( order );
 }
 
 bool OverlayManager::eventFilter( QObject *receiver, QEvent *event )
 {
   if ( receiver == nullptr )
     return false;
+  if ( event->type() == QEvent::Expose && receiver == main_window_.data() ) {
+    // QWindow has no signal for exposure changes, e.g., if the window is covered on some platforms
+    updatePowerState();
+    return false;
+  }
   if ( sending_event_ )
     return false;
   if ( !renderer_->isRendering() )
@@ -334,7 +615,7 @@ bool OverlayManager::handleMouseEvent( QObject *receiver, QMouseEvent *event )
   QPoint render_panel_pos = render_panel_->mapFromGlobal( event->globalPos() );
   if ( !render_panel_->contentsRect().contains( render_panel_pos ) && mouse_down_overlay_ == nullptr ) {
     if ( is_mouse_down )
-      focused_overlay_ = nullptr;
+      setFocusedOverlay( nullptr );
     if ( mouse_overlay_ != nullptr ) {
       mouse_overlay_->handleEventsCanceled();
       mouse_overlay_ = nullptr;
@@ -393,7 +674,7 @@ bool OverlayManager::handleMouseEvent( QObject *receiver, QMouseEvent *event )
     mouse_overlay_ = popup_overlay;
     if ( is_mouse_down ) {
       mouse_down_overlay_ = popup_overlay;
-      focused_overlay_ = popup_overlay;
+      setFocusedOverlay( popup_overlay );
     }
     event->setAccepted( true );
     return true;
@@ -413,7 +694,7 @@ bool OverlayManager::handleMouseEvent( QObject *receiver, QMouseEvent *event )
     mouse_overlay_ = ui_overlays_[i];
     if ( is_mouse_down ) {
       mouse_down_overlay_ = ui_overlays_[i];
-      focused_overlay_ = ui_overlays_[i];
+      setFocusedOverlay( ui_overlays_[i] );
     }
     event->setAccepted( true );
     return true;
@@ -422,7 +703,7 @@ bool OverlayManager::handleMouseEvent( QObject *receiver, QMouseEvent *event )
   // If mouse is down and no overlay handled it, we reset the focused overlay so that it doesn't
   // keep on eating all scroll and key events.
   if ( is_mouse_down ) {
-    focused_overlay_ = nullptr;
+    setFocusedOverlay( nullptr );
   }
   return false;
 }
@@ -463,6 +744,24 @@ bool OverlayManager::handleWheelEvent( QObject *receiver, QWheelEvent *event )
   return false;
 }
 
+void OverlayManager::setFocusedOverlay( const OverlayPtr &overlay )
+{
+  if ( overlay == focused_overlay_ )
+    return;
+  // Overlays that manage a focus themselves, e.g., the quick window of QML overlays, need to know
+  // whether they have the focus since they only receive key events while they are focused.
+  OverlayPtr old_overlay = focused_overlay_;
+  focused_overlay_ = overlay;
+  if ( old_overlay != nullptr ) {
+    QFocusEvent focus_out( QEvent::FocusOut, Qt::MouseFocusReason );
+    old_overlay->handleEvent( render_panel_, &focus_out );
+  }
+  if ( overlay != nullptr ) {
+    QFocusEvent focus_in( QEvent::FocusIn, Qt::MouseFocusReason );
+    overlay->handleEvent( render_panel_, &focus_in );
+  }
+}
+
 bool OverlayManager::handleKeyEvent( QObject *receiver, QKeyEvent *event )
 {
   if ( focused_overlay_ == nullptr )
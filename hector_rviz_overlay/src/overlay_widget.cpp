@@ -17,8 +17,57 @@
 
 #include "hector_rviz_overlay/overlay_widget.hpp"
 
+#include <QPainter>
+
 namespace hector_rviz_overlay
 {
 
+namespace
+{
+bool isTransparentContainer( const QWidget *widget )
+{
+  // Subclasses may paint anything in their paintEvent but plain QWidgets only paint a background
+  return widget->metaObject() == &QWidget::staticMetaObject && !widget->autoFillBackground() &&
+         !widget->testAttribute( Qt::WA_StyledBackground );
+}
+
+void renderChildren( QWidget *parent, QPainter *painter, const QPoint &offset, const QRect &clip )
+{
+  // Children are ordered from bottom to top, hence, the stacking order is preserved
+  for ( QObject *object : parent->children() ) {
+    auto *child = qobject_cast<QWidget *>( object );
+    if ( child == nullptr || child->isWindow() || child->isHidden() )
+      continue;
+    const QPoint child_offset = offset + child->pos();
+    const QRect rect = QRect( child_offset, child->size() ) & clip;
+    if ( rect.isEmpty() )
+      continue;
+    if ( isTransparentContainer( child ) ) {
+      renderChildren( child, painter, child_offset, rect );
+      continue;
+    }
+    // The top left of the source region is rendered at the target offset
+    child->render( painter, rect.topLeft(), QRegion( rect.translated( -child_offset ) ),
+                   QWidget::DrawWindowBackground | QWidget::DrawChildren );
+  }
+}
+} // namespace
+
 OverlayWidget::OverlayWidget() : QWidget() { setAttribute( Qt::WA_NoSystemBackground ); }
+
+void OverlayWidget::renderContent( QPainter *painter )
+{
+  // Style sheets are only applied when polishing, and they may set WA_StyledBackground.
+  ensurePolished();
+  if ( paintsBackground() ) {
+    render( painter );
+    return;
+  }
+  renderChildren( this, painter, QPoint( 0, 0 ), rect() );
+}
+
+bool OverlayWidget::paintsBackground() const
+{
+  return autoFillBackground() || testAttribute( Qt::WA_StyledBackground );
+}
 } // namespace hector_rviz_overlay
@@ -17,6 +17,8 @@
 
 #include "hector_rviz_overlay/path_helper.hpp"
 
+#include <QFile>
+
 #include <ament_index_cpp/get_package_share_directory.hpp>
 
 namespace hector_rviz_overlay
@@ -44,4 +46,20 @@ QString resolvePath( const QString &path )
   }
   return path;
 }
+
+QUrl resolveQmlUrl( const QString &path, bool prefer_files )
+{
+  if ( !path.startsWith( "package://" ) )
+    return QUrl( path );
+  // Same prefix as used by hector_rviz_overlay_add_qml_resources
+  QString resource_path = ":/packages/" + path.mid( 10 );
+  if ( !QFile::exists( resource_path ) )
+    return QUrl::fromLocalFile( resolvePath( path ) );
+  if ( prefer_files ) {
+    QString file_path = resolvePath( path );
+    if ( QFile::exists( file_path ) )
+      return QUrl::fromLocalFile( file_path );
+  }
+  return QUrl( "qrc" + resource_path );
+}
 } // namespace hector_rviz_overlay
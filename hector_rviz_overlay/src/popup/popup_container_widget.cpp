@@ -42,6 +42,7 @@ void PopupContainerWidget::setPopup( QWidget *value )
   }
   popup_ = value;
   popup_->setParent( this );
+  position_outdated_ = true;
   popup_->setGeometry( popup_->geometry().left(), popup_->geometry().top(),
                        popup_->sizeHint().width(), popup_->sizeHint().height() );
 }
@@ -59,38 +60,51 @@ bool PopupContainerWidget::event( QEvent *event )
   return QWidget::event( event );
 }
 
-void PopupContainerWidget::paintEvent( QPaintEvent *event )
+void PopupContainerWidget::updatePopupPosition()
 {
-  if ( popup_ == nullptr )
+  if ( popup_ == nullptr || tracker_ == nullptr )
     return;
 
-  if ( tracker_ != nullptr ) {
-    QPoint pos = tracker_->getPoint( geometry().width(), geometry().height() );
-    if ( pos != last_position_ ) {
-      // TODO Account for AnchorAuto
-      int x = pos.x();
-      int y = pos.y();
-      if ( anchor_point_ == AnchorCenter ) {
-        x = pos.x() - popup_->width() / 2;
-        y = pos.y() - popup_->height() / 2;
-      } else if ( anchor_point_ == AnchorTopRight ) {
-        x = pos.x() - popup_->width();
-      } else if ( anchor_point_ == AnchorBottomRight ) {
-        x = pos.x() - popup_->width();
-        y = pos.y() - popup_->height();
-      } else if ( anchor_point_ == AnchorBottomLeft ) {
-        y = pos.y() - popup_->height();
-      }
-
-      QRect popup_geometry( x, y, popup_->width(), popup_->height() );
-
-      if ( popup_->geometry() != popup_geometry ) {
-        popup_->setGeometry( popup_geometry );
-      }
-      last_position_ = pos;
-    }
+  // Trackers without a revision are queried on every update since their point may always change
+  const bool supports_revision = tracker_->supportsRevision();
+  uint64_t revision = supports_revision ? tracker_->revision() : 0;
+  if ( supports_revision && !position_outdated_ && revision == last_tracker_revision_ &&
+       size() == last_container_size_ && popup_->size() == last_popup_size_ )
+    return;
+  position_outdated_ = false;
+  last_tracker_revision_ = revision;
+  last_container_size_ = size();
+  last_popup_size_ = popup_->size();
+
+  QPoint pos = tracker_->getPoint( geometry().width(), geometry().height() );
+  // TODO Account for AnchorAuto
+  int x = pos.x();
+  int y = pos.y();
+  if ( anchor_point_ == AnchorCenter ) {
+    x = pos.x() - popup_->width() / 2;
+    y = pos.y() - popup_->height() / 2;
+  } else if ( anchor_point_ == AnchorTopRight ) {
+    x = pos.x() - popup_->width();
+  } else if ( anchor_point_ == AnchorBottomRight ) {
+    x = pos.x() - popup_->width();
+    y = pos.y() - popup_->height();
+  } else if ( anchor_point_ == AnchorBottomLeft ) {
+    y = pos.y() - popup_->height();
   }
 
+  QRect popup_geometry( x, y, popup_->width(), popup_->height() );
+
+  if ( popup_->geometry() != popup_geometry ) {
+    popup_->setGeometry( popup_geometry );
+  }
+  last_position_ = pos;
+}
+
+void PopupContainerWidget::paintEvent( QPaintEvent *event )
+{
+  if ( popup_ == nullptr )
+    return;
+
   QWidget::paintEvent( event );
   if ( !is_modal_ )
     return;
@@ -98,6 +112,12 @@ void PopupContainerWidget::paintEvent( QPaintEvent *event )
   painter.fillRect( 0, 0, geometry().width(), geometry().height(), modal_color_ );
 }
 
+bool PopupContainerWidget::paintsBackground() const
+{
+  // The modal color fills the whole widget
+  return ( popup_ != nullptr && is_modal_ ) || OverlayWidget::paintsBackground();
+}
+
 bool PopupContainerWidget::isModalPopup() const { return is_modal_; }
 
 void PopupContainerWidget::setIsModalPopup( bool value ) { is_modal_ = value; }
@@ -108,11 +128,16 @@ void PopupContainerWidget::setModalColor( const QColor &color ) { modal_color_ =
 
 AnchorPoint PopupContainerWidget::anchorPoint() const { return anchor_point_; }
 
-void PopupContainerWidget::setAnchorPoint( AnchorPoint value ) { anchor_point_ = value; }
+void PopupContainerWidget::setAnchorPoint( AnchorPoint value )
+{
+  anchor_point_ = value;
+  position_outdated_ = true;
+}
 
 void PopupContainerWidget::trackPoint( std::shared_ptr<PointTracker> tracker )
 {
   tracker_ = std::move( tracker );
+  position_outdated_ = true;
 }
 
 QPoint PopupContainerWidget::popupPosition() const { return popup_->pos(); }
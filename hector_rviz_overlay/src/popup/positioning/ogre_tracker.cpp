@@ -16,11 +16,7 @@
  */
 
 #include "hector_rviz_overlay/popup/positioning/ogre_tracker.hpp"
-
-#include <rviz_common/display_context.hpp>
-#include <rviz_common/view_manager.hpp>
-
-#include <OgreCamera.h>
+#include "hector_rviz_overlay/positioning/camera_snapshot_service.hpp"
 
 namespace hector_rviz_overlay
 {
@@ -28,16 +24,27 @@ namespace hector_rviz_overlay
 OgreTracker::OgreTracker( const Ogre::Vector3 &point, const rviz_common::DisplayContext *context )
     : point_( point ), context_( context )
 {
+  positioning::CameraSnapshotService::getSingleton().attach( context_ );
 }
 
 QPoint OgreTracker::getPoint( int width, int height )
 {
-  Ogre::Camera *camera_ = context_->getViewManager()->getCurrent()->getCamera();
-  Ogre::Vector4 screen_point = camera_->getProjectionMatrix() * camera_->getViewMatrix() *
-                               Ogre::Vector4( point_.x, point_.y, point_.z, 1 );
+  const positioning::CameraSnapshot &snapshot =
+      positioning::CameraSnapshotService::getSingleton().snapshot();
+  if ( !snapshot.valid )
+    return { width / 2, height / 2 };
+  Ogre::Vector4 screen_point =
+      snapshot.view_projection * Ogre::Vector4( point_.x, point_.y, point_.z, 1 );
   double x = screen_point.x * 0.5 / screen_point.w + 0.5;
   double y = -screen_point.y * 0.5 / screen_point.w + 0.5;
 
   return { (int)( x * width ), (int)( y * height ) };
 }
+
+bool OgreTracker::supportsRevision() const { return true; }
+
+uint64_t OgreTracker::revision()
+{
+  return positioning::CameraSnapshotService::getSingleton().snapshot().revision;
+}
 } // namespace hector_rviz_overlay
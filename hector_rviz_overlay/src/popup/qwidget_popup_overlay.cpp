@@ -61,11 +61,14 @@ void QWidgetPopupOverlay::setGeometry( const QRect &value )
                                (int)( geometry().height() / scale() ) ) );
 }
 
+void QWidgetPopupOverlay::update( float ) { widget_->updatePopupPosition(); }
+
 void QWidgetPopupOverlay::renderImpl( Renderer *renderer )
 {
   QPainter painter( renderer->paintDevice() );
-  painter.scale( scale(), scale() );
-  widget_->render( &painter );
+  const float render_scale = scale() * renderer->resolutionScale();
+  painter.scale( render_scale, render_scale );
+  widget_->renderContent( &painter );
 }
 
 void QWidgetPopupOverlay::handleEventsCanceled() { event_manager_->handleEventsCanceled(); }
@@ -0,0 +1,155 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/positioning/camera_snapshot_service.hpp"
+
+#include <QCoreApplication>
+
+#include <rviz_common/display_context.hpp>
+#include <rviz_common/view_manager.hpp>
+
+#include <OgreCamera.h>
+#include <OgreRoot.h>
+#include <OgreViewport.h>
+
+namespace hector_rviz_overlay
+{
+namespace positioning
+{
+
+class CameraSnapshotService::Listener : public Ogre::Camera::Listener
+{
+public:
+  explicit Listener( CameraSnapshotService *parent ) : parent_( parent ) { }
+
+  void cameraPreRenderScene( Ogre::Camera * ) override { parent_->onCameraPreRenderScene(); }
+
+  void cameraDestroyed( Ogre::Camera * ) override { parent_->onCameraDestroyed(); }
+
+private:
+  CameraSnapshotService *parent_;
+};
+
+CameraSnapshotService &CameraSnapshotService::getSingleton()
+{
+  static CameraSnapshotService instance;
+  return instance;
+}
+
+CameraSnapshotService::CameraSnapshotService()
+{
+  listener_ = std::make_unique<Listener>( this );
+  connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+           &CameraSnapshotService::onAboutToQuit, Qt::DirectConnection );
+}
+
+CameraSnapshotService::~CameraSnapshotService() = default;
+
+void CameraSnapshotService::attach( const rviz_common::DisplayContext *context )
+{
+  if ( context_ != nullptr || context == nullptr )
+    return;
+  context_ = context;
+  connect( context_->getViewManager(), &rviz_common::ViewManager::currentChanged, this,
+           &CameraSnapshotService::updateCamera );
+  updateCamera();
+}
+
+const CameraSnapshot &CameraSnapshotService::snapshot()
+{
+  refresh( false );
+  return snapshot_;
+}
+
+Ogre::Camera *CameraSnapshotService::camera() const { return camera_; }
+
+void CameraSnapshotService::updateCamera()
+{
+  Ogre::Camera *camera = nullptr;
+  if ( context_ != nullptr && context_->getViewManager()->getCurrent() != nullptr )
+    camera = context_->getViewManager()->getCurrent()->getCamera();
+  if ( camera == camera_ )
+    return;
+  if ( camera_ != nullptr )
+    camera_->removeListener( listener_.get() );
+  camera_ = camera;
+  if ( camera_ != nullptr )
+    camera_->addListener( listener_.get() );
+  refresh( true );
+  emit cameraChanged( camera_ );
+}
+
+void CameraSnapshotService::onAboutToQuit()
+{
+  if ( camera_ != nullptr )
+    camera_->removeListener( listener_.get() );
+  camera_ = nullptr;
+  context_ = nullptr;
+}
+
+void CameraSnapshotService::refresh( bool force )
+{
+  const unsigned long frame_id = Ogre::Root::getSingleton().getNextFrameNumber();
+  if ( !force && snapshot_.frame_id == frame_id )
+    return;
+  snapshot_.frame_id = frame_id;
+  if ( camera_ == nullptr || camera_->getViewport() == nullptr ) {
+    if ( snapshot_.valid ) {
+      snapshot_.valid = false;
+      ++snapshot_.revision;
+    }
+    return;
+  }
+  const Ogre::Matrix4 &view = camera_->getViewMatrix();
+  const Ogre::Matrix4 &projection = camera_->getProjectionMatrix();
+  const Ogre::Viewport *viewport = camera_->getViewport();
+  const int width = viewport->getActualWidth();
+  const int height = viewport->getActualHeight();
+  if ( snapshot_.valid && snapshot_.view == view && snapshot_.projection == projection &&
+       snapshot_.viewport_width == width && snapshot_.viewport_height == height )
+    return;
+  snapshot_.view = view;
+  snapshot_.projection = projection;
+  snapshot_.view_projection = projection * view;
+  snapshot_.viewport_width = width;
+  snapshot_.viewport_height = height;
+  snapshot_.valid = true;
+  ++snapshot_.revision;
+}
+
+void CameraSnapshotService::onCameraPreRenderScene()
+{
+  // A lazy refresh earlier in this frame may have seen the matrices before the view controller
+  // updated the camera, hence, always take the matrices the scene is rendered with.
+  refresh( true );
+  emit frameStarted();
+  if ( snapshot_.revision == last_signaled_revision_ )
+    return;
+  last_signaled_revision_ = snapshot_.revision;
+  emit snapshotChanged();
+}
+
+void CameraSnapshotService::onCameraDestroyed()
+{
+  // The listener is removed by the camera itself. The new camera is obtained once the view manager
+  // signals that the current view changed.
+  camera_ = nullptr;
+  refresh( true );
+  emit cameraChanged( nullptr );
+}
+} // namespace positioning
+} // namespace hector_rviz_overlay
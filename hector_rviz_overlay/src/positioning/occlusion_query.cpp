@@ -0,0 +1,452 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/positioning/occlusion_query.hpp"
+#include "hector_rviz_overlay/positioning/camera_snapshot_service.hpp"
+#include "../logging.hpp"
+
+#include <GL/glew.h>
+
+#include <QCoreApplication>
+
+#include <OgreCamera.h>
+#include <OgreRenderTarget.h>
+#include <OgreViewport.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace hector_rviz_overlay
+{
+namespace positioning
+{
+namespace
+{
+// If the bounding box of all samples is at most this many pixels, the depth is read in one call.
+// Otherwise, each sample is read separately to keep the read-back buffer small.
+constexpr int MaxBatchReadArea = 512 * 512;
+
+// The number of read-backs that can be in flight. If the GPU has not finished any of them, no new
+// read-back is started in that frame.
+constexpr size_t ReadBackCount = 2;
+
+float depthToDistance( const Ogre::Matrix4 &projection, float depth )
+{
+  // Invert the projection for the z-component. Works for perspective and orthographic projections.
+  const float z_ndc = 2 * depth - 1;
+  const float z_eye = ( projection[2][3] - z_ndc * projection[3][3] ) /
+                      ( z_ndc * projection[3][2] - projection[2][2] );
+  return -z_eye;
+}
+
+//! Loads the GL functions using GLEW. Has to be called with the render window's context current.
+bool loadGlFunctions()
+{
+  static const bool loaded = []() {
+    glewExperimental = GL_TRUE;
+    if ( glewInit() != GLEW_OK )
+      return false;
+    // glewInit may leave an invalid enum error in core profiles
+    glGetError();
+    return GLEW_VERSION_3_2 ||
+           ( GLEW_ARB_sync && GLEW_ARB_framebuffer_object && GLEW_ARB_map_buffer_range &&
+             GLEW_ARB_pixel_buffer_object );
+  }();
+  return loaded;
+}
+
+//! @return The internal format matching the depth buffer of the given framebuffer or GL_NONE.
+GLenum depthFormat( GLuint framebuffer )
+{
+  const GLenum depth_attachment = framebuffer == 0 ? GL_DEPTH : GL_DEPTH_ATTACHMENT;
+  const GLenum stencil_attachment = framebuffer == 0 ? GL_STENCIL : GL_STENCIL_ATTACHMENT;
+  GLint depth_bits = 0, stencil_bits = 0, type = GL_NONE;
+  glGetFramebufferAttachmentParameteriv( GL_READ_FRAMEBUFFER, depth_attachment,
+                                         GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depth_bits );
+  glGetFramebufferAttachmentParameteriv( GL_READ_FRAMEBUFFER, depth_attachment,
+                                         GL_FRAMEBUFFER_ATTACHMENT_COMPONENT_TYPE, &type );
+  glGetFramebufferAttachmentParameteriv( GL_READ_FRAMEBUFFER, stencil_attachment,
+                                         GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencil_bits );
+  // Depth can only be blitted between buffers with the same depth and stencil format
+  const bool stencil = stencil_bits > 0;
+  if ( type == GL_FLOAT )
+    return stencil ? GL_DEPTH32F_STENCIL8 : GL_DEPTH_COMPONENT32F;
+  switch ( depth_bits ) {
+  case 16:
+    return stencil ? GL_NONE : GL_DEPTH_COMPONENT16;
+  case 24:
+    return stencil ? GL_DEPTH24_STENCIL8 : GL_DEPTH_COMPONENT24;
+  case 32:
+    return stencil ? GL_NONE : GL_DEPTH_COMPONENT32;
+  default:
+    return GL_NONE;
+  }
+}
+} // namespace
+
+struct OcclusionQuery::ReadBack {
+  Ogre::Camera *camera = nullptr;
+  Ogre::Matrix4 projection;
+  std::vector<Sample> samples;
+  //! The frame in which the read-back was started.
+  unsigned frame = 0;
+  GLuint buffer = 0;
+  GLsizeiptr size = 0;
+  GLsizeiptr capacity = 0;
+  //! Signaled once the depth was copied into the buffer. Null if no read-back is in flight.
+  GLsync fence = nullptr;
+};
+
+class OcclusionQuery::Listener : public Ogre::Camera::Listener
+{
+public:
+  explicit Listener( OcclusionQuery *parent ) : parent_( parent ) { }
+
+  void cameraPostRenderScene( Ogre::Camera *camera ) override { parent_->runQuery( camera ); }
+
+  void cameraDestroyed( Ogre::Camera * ) override { parent_->camera_ = nullptr; }
+
+private:
+  OcclusionQuery *parent_;
+};
+
+OcclusionQuery &OcclusionQuery::getSingleton()
+{
+  static OcclusionQuery instance;
+  return instance;
+}
+
+OcclusionQuery::OcclusionQuery()
+{
+  listener_ = std::make_unique<Listener>( this );
+  connect( QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this,
+           &OcclusionQuery::onAboutToQuit, Qt::DirectConnection );
+  CameraSnapshotService &snapshot_service = CameraSnapshotService::getSingleton();
+  connect( &snapshot_service, &CameraSnapshotService::cameraChanged, this,
+           &OcclusionQuery::updateCamera );
+  updateCamera( snapshot_service.camera() );
+}
+
+OcclusionQuery::~OcclusionQuery() = default;
+
+void OcclusionQuery::onAboutToQuit()
+{
+  // Detach before the camera is destroyed, otherwise the listener would be called during shutdown.
+  if ( camera_ != nullptr )
+    camera_->removeListener( listener_.get() );
+  camera_ = nullptr;
+  targets_.clear();
+  occluded_.clear();
+  // The render window's context is not current here, the GL objects are freed with the context.
+  read_backs_.clear();
+  resolve_framebuffer_ = 0;
+  resolve_depth_buffer_ = 0;
+}
+
+void OcclusionQuery::addTarget( Target *target )
+{
+  if ( std::find( targets_.begin(), targets_.end(), target ) != targets_.end() )
+    return;
+  targets_.push_back( target );
+  occluded_.push_back( false );
+}
+
+void OcclusionQuery::removeTarget( Target *target )
+{
+  auto it = std::find( targets_.begin(), targets_.end(), target );
+  if ( it == targets_.end() )
+    return;
+  occluded_.erase( occluded_.begin() + ( it - targets_.begin() ) );
+  targets_.erase( it );
+  // A new target could be created at the same address before the pending read-backs are evaluated
+  for ( auto &read_back : read_backs_ ) {
+    auto &samples = read_back.samples;
+    samples.erase( std::remove_if( samples.begin(), samples.end(),
+                                   [target]( const Sample &sample ) {
+                                     return sample.target == target;
+                                   } ),
+                   samples.end() );
+  }
+}
+
+float OcclusionQuery::depthTolerance() const { return depth_tolerance_; }
+
+void OcclusionQuery::setDepthTolerance( float value ) { depth_tolerance_ = value; }
+
+void OcclusionQuery::updateCamera( Ogre::Camera *camera )
+{
+  if ( camera_ != nullptr )
+    camera_->removeListener( listener_.get() );
+  camera_ = camera;
+  if ( camera_ != nullptr )
+    camera_->addListener( listener_.get() );
+}
+
+void OcclusionQuery::runQuery( Ogre::Camera *camera )
+{
+  if ( unsupported_ )
+    return;
+  ++frame_;
+  // The render window's context is current at this point and the scene was just rendered
+  if ( targets_.empty() ) {
+    releaseReadBacks();
+    return;
+  }
+  if ( !loadGlFunctions() ) {
+    LOG_WARN( "OcclusionQuery: OpenGL 3.2 or the required extensions are not available. Occlusion "
+              "of popups is not tested." );
+    unsupported_ = true;
+    return;
+  }
+  consumeReadBacks( camera );
+
+  const Ogre::Viewport *viewport = camera->getViewport();
+  const CameraSnapshot &snapshot = CameraSnapshotService::getSingleton().snapshot();
+  if ( viewport == nullptr || viewport->getTarget() == nullptr || !snapshot.valid )
+    return;
+
+  const int viewport_left = viewport->getActualLeft();
+  const int viewport_top = viewport->getActualTop();
+  const int viewport_width = snapshot.viewport_width;
+  const int viewport_height = snapshot.viewport_height;
+  const int target_height = static_cast<int>( viewport->getTarget()->getHeight() );
+  const Ogre::Matrix4 &view = snapshot.view;
+  const Ogre::Matrix4 &view_projection = snapshot.view_projection;
+
+  // Project all targets first to know which region of the depth buffer we need
+  samples_.clear();
+  for ( size_t i = 0; i < targets_.size(); ++i ) {
+    const Ogre::Vector3 &point = targets_[i]->occlusionTestPoint();
+    Ogre::Vector4 clip = view_projection * Ogre::Vector4( point.x, point.y, point.z, 1 );
+    if ( clip.w <= 0 || std::abs( clip.x ) > clip.w || std::abs( clip.y ) > clip.w ) {
+      // Behind the camera or outside of the view, we can't tell if it is occluded
+      if ( occluded_[i] ) {
+        occluded_[i] = false;
+        targets_[i]->setOccluded( false );
+      }
+      continue;
+    }
+    int x = viewport_left + static_cast<int>( ( clip.x / clip.w * 0.5f + 0.5f ) * viewport_width );
+    int y = viewport_top + static_cast<int>( ( -clip.y / clip.w * 0.5f + 0.5f ) * viewport_height );
+    // OpenGL's origin is at the bottom left
+    y = target_height - 1 - std::min( y, viewport_top + viewport_height - 1 );
+    x = std::min( x, viewport_left + viewport_width - 1 );
+    float distance = -( view * point ).z;
+    samples_.push_back( { targets_[i], x, y, distance, 0 } );
+  }
+  if ( samples_.empty() )
+    return;
+  startReadBack( camera, snapshot.projection );
+}
+
+void OcclusionQuery::consumeReadBacks( Ogre::Camera *camera )
+{
+  while ( true ) {
+    // Evaluate in the order they were started, a newer result overrides an older one
+    ReadBack *read_back = nullptr;
+    for ( auto &candidate : read_backs_ ) {
+      if ( candidate.fence == nullptr )
+        continue;
+      if ( read_back == nullptr || candidate.frame < read_back->frame )
+        read_back = &candidate;
+    }
+    if ( read_back == nullptr )
+      return;
+    GLenum status = glClientWaitSync( read_back->fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0 );
+    // If the oldest is not finished, the newer ones are not either
+    if ( status == GL_TIMEOUT_EXPIRED )
+      return;
+    glDeleteSync( read_back->fence );
+    read_back->fence = nullptr;
+    // The samples are invalid if the camera changed in the meantime
+    if ( status == GL_WAIT_FAILED || read_back->camera != camera )
+      continue;
+
+    // Copy the depth values to not keep the buffer mapped while the targets are notified
+    GLint previous_pack_buffer = 0;
+    glGetIntegerv( GL_PIXEL_PACK_BUFFER_BINDING, &previous_pack_buffer );
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, read_back->buffer );
+    const void *data =
+        glMapBufferRange( GL_PIXEL_PACK_BUFFER, 0, read_back->size, GL_MAP_READ_BIT );
+    depth_buffer_.resize( read_back->size / sizeof( float ) );
+    if ( data != nullptr ) {
+      std::memcpy( depth_buffer_.data(), data, read_back->size );
+      glUnmapBuffer( GL_PIXEL_PACK_BUFFER );
+    }
+    glBindBuffer( GL_PIXEL_PACK_BUFFER, previous_pack_buffer );
+    if ( data == nullptr )
+      continue;
+
+    const Ogre::Matrix4 projection = read_back->projection;
+    samples_.swap( read_back->samples );
+    for ( const Sample &sample : samples_ ) {
+      float depth = depth_buffer_[sample.offset];
+      // A depth of 1 means nothing was rendered at this pixel
+      bool occluded =
+          depth < 1.0f && depthToDistance( projection, depth ) < sample.distance - depth_tolerance_;
+      auto it = std::find( targets_.begin(), targets_.end(), sample.target );
+      if ( it == targets_.end() )
+        continue;
+      size_t index = it - targets_.begin();
+      if ( occluded_[index] == occluded )
+        continue;
+      occluded_[index] = occluded;
+      sample.target->setOccluded( occluded );
+    }
+  }
+}
+
+void OcclusionQuery::startReadBack( Ogre::Camera *camera, const Ogre::Matrix4 &projection )
+{
+  if ( read_backs_.empty() )
+    read_backs_.resize( ReadBackCount );
+  auto it = std::find_if( read_backs_.begin(), read_backs_.end(),
+                          []( const ReadBack &read_back ) { return read_back.fence == nullptr; } );
+  // The GPU is behind, try again next frame instead of stalling
+  if ( it == read_backs_.end() )
+    return;
+  ReadBack &read_back = *it;
+
+  int min_x = std::numeric_limits<int>::max(), min_y = std::numeric_limits<int>::max();
+  int max_x = std::numeric_limits<int>::min(), max_y = std::numeric_limits<int>::min();
+  for ( const Sample &sample : samples_ ) {
+    min_x = std::min( min_x, sample.x );
+    min_y = std::min( min_y, sample.y );
+    max_x = std::max( max_x, sample.x );
+    max_y = std::max( max_y, sample.y );
+  }
+  const int width = max_x - min_x + 1;
+  const int height = max_y - min_y + 1;
+  const bool batch_read = width * height <= MaxBatchReadArea;
+  for ( size_t i = 0; i < samples_.size(); ++i ) {
+    Sample &sample = samples_[i];
+    sample.offset = batch_read ? ( sample.y - min_y ) * width + ( sample.x - min_x ) : i;
+  }
+
+  GLint previous_read_framebuffer = 0, previous_draw_framebuffer = 0, previous_pack_buffer = 0;
+  glGetIntegerv( GL_READ_FRAMEBUFFER_BINDING, &previous_read_framebuffer );
+  glGetIntegerv( GL_DRAW_FRAMEBUFFER_BINDING, &previous_draw_framebuffer );
+  glGetIntegerv( GL_PIXEL_PACK_BUFFER_BINDING, &previous_pack_buffer );
+  GLint sample_buffers = 0;
+  glGetIntegerv( GL_SAMPLE_BUFFERS, &sample_buffers );
+  if ( sample_buffers > 0 ) {
+    // The depth of a multisampled buffer can not be read directly, resolve the sampled region
+    const Ogre::RenderTarget *target = camera->getViewport()->getTarget();
+    if ( !prepareResolveFramebuffer( static_cast<int>( target->getWidth() ),
+                                     static_cast<int>( target->getHeight() ),
+                                     previous_read_framebuffer ) ) {
+      LOG_WARN( "OcclusionQuery: The format of the multisampled depth buffer is not supported. "
+                "Occlusion of popups is not tested." );
+      unsupported_ = true;
+      return;
+    }
+    glGetError();
+    glBindFramebuffer( GL_DRAW_FRAMEBUFFER, resolve_framebuffer_ );
+    glBlitFramebuffer( min_x, min_y, max_x + 1, max_y + 1, min_x, min_y, max_x + 1, max_y + 1,
+                       GL_DEPTH_BUFFER_BIT, GL_NEAREST );
+    glBindFramebuffer( GL_DRAW_FRAMEBUFFER, previous_draw_framebuffer );
+    if ( glGetError() != GL_NO_ERROR ) {
+      LOG_WARN( "OcclusionQuery: Failed to resolve the multisampled depth buffer. Occlusion of "
+                "popups is not tested." );
+      unsupported_ = true;
+      return;
+    }
+    glBindFramebuffer( GL_READ_FRAMEBUFFER, resolve_framebuffer_ );
+  }
+
+  // Reading into a pixel buffer returns immediately, the data is mapped once the fence is signaled
+  if ( read_back.buffer == 0 )
+    glGenBuffers( 1, &read_back.buffer );
+  glBindBuffer( GL_PIXEL_PACK_BUFFER, read_back.buffer );
+  const size_t count = batch_read ? static_cast<size_t>( width * height ) : samples_.size();
+  read_back.size = static_cast<GLsizeiptr>( count * sizeof( float ) );
+  if ( read_back.capacity < read_back.size ) {
+    glBufferData( GL_PIXEL_PACK_BUFFER, read_back.size, nullptr, GL_STREAM_READ );
+    read_back.capacity = read_back.size;
+  }
+  if ( batch_read ) {
+    glReadPixels( min_x, min_y, width, height, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr );
+  } else {
+    for ( const Sample &sample : samples_ ) {
+      glReadPixels( sample.x, sample.y, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT,
+                    reinterpret_cast<void *>( sample.offset * sizeof( float ) ) );
+    }
+  }
+  read_back.fence = glFenceSync( GL_SYNC_GPU_COMMANDS_COMPLETE, 0 );
+  glBindBuffer( GL_PIXEL_PACK_BUFFER, previous_pack_buffer );
+  glBindFramebuffer( GL_READ_FRAMEBUFFER, previous_read_framebuffer );
+
+  read_back.camera = camera;
+  read_back.projection = projection;
+  read_back.frame = frame_;
+  read_back.samples.assign( samples_.begin(), samples_.end() );
+}
+
+bool OcclusionQuery::prepareResolveFramebuffer( int width, int height, unsigned source_framebuffer )
+{
+  if ( resolve_framebuffer_ != 0 && resolve_width_ == width && resolve_height_ == height )
+    return true;
+  const GLenum format = depthFormat( source_framebuffer );
+  if ( format == GL_NONE )
+    return false;
+  if ( resolve_framebuffer_ == 0 ) {
+    glGenFramebuffers( 1, &resolve_framebuffer_ );
+    glGenRenderbuffers( 1, &resolve_depth_buffer_ );
+  }
+  GLint previous_renderbuffer = 0, previous_draw_framebuffer = 0;
+  glGetIntegerv( GL_RENDERBUFFER_BINDING, &previous_renderbuffer );
+  glGetIntegerv( GL_DRAW_FRAMEBUFFER_BINDING, &previous_draw_framebuffer );
+  glBindRenderbuffer( GL_RENDERBUFFER, resolve_depth_buffer_ );
+  glRenderbufferStorage( GL_RENDERBUFFER, format, width, height );
+  glBindRenderbuffer( GL_RENDERBUFFER, previous_renderbuffer );
+  glBindFramebuffer( GL_DRAW_FRAMEBUFFER, resolve_framebuffer_ );
+  const bool has_stencil = format == GL_DEPTH24_STENCIL8 || format == GL_DEPTH32F_STENCIL8;
+  glFramebufferRenderbuffer( GL_DRAW_FRAMEBUFFER,
+                             has_stencil ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT,
+                             GL_RENDERBUFFER, resolve_depth_buffer_ );
+  // There is no color attachment
+  glDrawBuffer( GL_NONE );
+  bool complete = glCheckFramebufferStatus( GL_DRAW_FRAMEBUFFER ) == GL_FRAMEBUFFER_COMPLETE;
+  glBindFramebuffer( GL_DRAW_FRAMEBUFFER, previous_draw_framebuffer );
+  glBindFramebuffer( GL_READ_FRAMEBUFFER, resolve_framebuffer_ );
+  glReadBuffer( GL_NONE );
+  glBindFramebuffer( GL_READ_FRAMEBUFFER, source_framebuffer );
+  resolve_width_ = width;
+  resolve_height_ = height;
+  return complete;
+}
+
+void OcclusionQuery::releaseReadBacks()
+{
+  for ( auto &read_back : read_backs_ ) {
+    if ( read_back.fence != nullptr )
+      glDeleteSync( read_back.fence );
+    if ( read_back.buffer != 0 )
+      glDeleteBuffers( 1, &read_back.buffer );
+  }
+  read_backs_.clear();
+  if ( resolve_framebuffer_ == 0 )
+    return;
+  glDeleteFramebuffers( 1, &resolve_framebuffer_ );
+  glDeleteRenderbuffers( 1, &resolve_depth_buffer_ );
+  resolve_framebuffer_ = 0;
+  resolve_depth_buffer_ = 0;
+}
+} // namespace positioning
+} // namespace hector_rviz_overlay
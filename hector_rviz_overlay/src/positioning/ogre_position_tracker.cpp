@@ -17,57 +17,52 @@
 
 #include "hector_rviz_overlay/positioning/ogre_position_tracker.hpp"
 #include "hector_rviz_overlay/overlay.hpp"
+#include "hector_rviz_overlay/positioning/camera_snapshot_service.hpp"
 
-#include <rviz_common/display_context.hpp>
-#include <rviz_common/view_manager.hpp>
-
-#include <OgreCamera.h>
-#include <OgreViewport.h>
+#include <cmath>
+#include <limits>
 
 namespace hector_rviz_overlay
 {
 namespace positioning
 {
 
-class OgrePositionTracker::Listener : public Ogre::Camera::Listener
-{
-public:
-  explicit Listener( OgrePositionTracker *parent ) : parent_( parent ) { }
-
-  void cameraPreRenderScene( Ogre::Camera * ) override { parent_->checkPosition(); }
-
-  void cameraDestroyed( Ogre::Camera * ) override { parent_->updateCamera(); }
-
-private:
-  OgrePositionTracker *parent_;
-};
-
 OgrePositionTracker::OgrePositionTracker( const Ogre::Vector3 &point,
                                           const rviz_common::DisplayContext *context,
                                           const Overlay *overlay )
     : point_( point ), context_( context ), overlay_( overlay )
 {
-  listener_.reset( new OgrePositionTracker::Listener( this ) );
-  updateCamera();
+  CameraSnapshotService &snapshot_service = CameraSnapshotService::getSingleton();
+  snapshot_service.attach( context_ );
+  connect( &snapshot_service, &CameraSnapshotService::frameStarted, this,
+           &OgrePositionTracker::checkPosition );
+  OcclusionQuery::getSingleton().addTarget( this );
 }
 
-OgrePositionTracker::~OgrePositionTracker()
-{
-  if ( camera_ != nullptr ) {
-    camera_->removeListener( listener_.get() );
-  }
-}
+OgrePositionTracker::~OgrePositionTracker() { OcclusionQuery::getSingleton().removeTarget( this ); }
+
+const Ogre::Vector3 &OgrePositionTracker::occlusionTestPoint() const { return point_; }
+
+void OgrePositionTracker::setOccluded( bool occluded ) { updateOccluded( occluded ); }
 
 void OgrePositionTracker::checkPosition()
 {
-  Ogre::Vector4 screen_point = camera_->getProjectionMatrix() * camera_->getViewMatrix() *
-                               Ogre::Vector4( point_.x, point_.y, point_.z, 1 );
+  const CameraSnapshot &snapshot = CameraSnapshotService::getSingleton().snapshot();
+  if ( !snapshot.valid )
+    return;
+  // Nothing changed since the last check, no need to project the point again
+  if ( snapshot.revision == last_revision_ && overlay_->scale() == last_scale_ )
+    return;
+  last_revision_ = snapshot.revision;
+  last_scale_ = overlay_->scale();
+
+  Ogre::Vector4 screen_point =
+      snapshot.view_projection * Ogre::Vector4( point_.x, point_.y, point_.z, 1 );
   float x = screen_point.x * 0.5 / screen_point.w + 0.5;
   float y = -screen_point.y * 0.5 / screen_point.w + 0.5;
   float z = screen_point.z < 0 ? std::numeric_limits<float>::quiet_NaN() : screen_point.z;
-  const Ogre::Viewport *viewport = camera_->getViewport();
-  x *= viewport->getActualWidth() / overlay_->scale();
-  y *= viewport->getActualHeight() / overlay_->scale();
+  x *= snapshot.viewport_width / overlay_->scale();
+  y *= snapshot.viewport_height / overlay_->scale();
   if ( std::abs( x - position().x() ) < 1E-2 && std::abs( y - position().y() ) < 1E-2 &&
        ( ( std::isnan( z ) && std::isnan( position().z() ) ) ||
          ( !std::isnan( z ) && !std::isnan( position().z() ) &&
@@ -76,14 +71,5 @@ void OgrePositionTracker::checkPosition()
 
   updatePosition( QVector3D( x, y, z ) );
 }
-
-void OgrePositionTracker::updateCamera()
-{
-  if ( camera_ != nullptr )
-    camera_->removeListener( listener_.get() );
-  camera_ = context_->getViewManager()->getCurrent()->getCamera();
-  if ( camera_ != nullptr )
-    camera_->addListener( listener_.get() );
-}
 } // namespace positioning
 } // namespace hector_rviz_overlay
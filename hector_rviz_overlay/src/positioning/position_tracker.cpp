@@ -29,5 +29,15 @@ void PositionTracker::updatePosition( const QVector3D &position )
   position_ = position;
   emit positionChanged( position_ );
 }
+
+bool PositionTracker::occluded() const { return occluded_; }
+
+void PositionTracker::updateOccluded( bool occluded )
+{
+  if ( occluded_ == occluded )
+    return;
+  occluded_ = occluded;
+  emit occludedChanged( occluded_ );
+}
 } // namespace positioning
 } // namespace hector_rviz_overlay
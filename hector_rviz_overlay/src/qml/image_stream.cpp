@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/qml/image_stream.hpp"
+
+#include <QHash>
+#include <QMetaObject>
+#include <QObject>
+
+#include <algorithm>
+#include <cstring>
+
+namespace hector_rviz_overlay
+{
+
+int ImageStreamFrame::bytesPerPixel( Format format )
+{
+  switch ( format ) {
+  case Rgba8:
+  case Bgra8:
+    return 4;
+  case Rgb8:
+  case Bgr8:
+    return 3;
+  case Mono8:
+    return 1;
+  }
+  return 4;
+}
+
+ImageStream::FrameWriter::FrameWriter( ImageStream *stream, std::unique_lock<std::mutex> lock,
+                                       ImageStreamFrame *frame )
+    : stream_( stream ), lock_( std::move( lock ) ), frame_( frame )
+{
+}
+
+ImageStream::FrameWriter::FrameWriter( FrameWriter &&other ) noexcept
+    : stream_( other.stream_ ), lock_( std::move( other.lock_ ) ), frame_( other.frame_ )
+{
+  other.stream_ = nullptr;
+  other.frame_ = nullptr;
+}
+
+ImageStream::FrameWriter::~FrameWriter()
+{
+  // The lock is released after the frame was published
+  if ( stream_ != nullptr )
+    stream_->publish();
+}
+
+std::shared_ptr<ImageStream> ImageStream::get( const QString &name )
+{
+  static std::mutex mutex;
+  // Weak references, so that the frames of streams no one uses anymore are freed
+  static QHash<QString, std::weak_ptr<ImageStream>> streams;
+  std::lock_guard<std::mutex> lock( mutex );
+  std::weak_ptr<ImageStream> &entry = streams[name];
+  std::shared_ptr<ImageStream> stream = entry.lock();
+  if ( stream != nullptr )
+    return stream;
+  // Drop the entries of other expired streams, so that the registry does not grow with the names
+  for ( auto it = streams.begin(); it != streams.end(); ) {
+    if ( it.key() != name && it.value().expired() )
+      it = streams.erase( it );
+    else
+      ++it;
+  }
+  stream = std::shared_ptr<ImageStream>( new ImageStream );
+  streams[name] = stream;
+  return stream;
+}
+
+ImageStream::FrameWriter ImageStream::beginFrame( int width, int height,
+                                                  ImageStreamFrame::Format format )
+{
+  std::unique_lock<std::mutex> lock( producer_mutex_ );
+  ImageStreamFrame &frame = frames_[back_index_];
+  frame.width = std::max( 0, width );
+  frame.height = std::max( 0, height );
+  frame.format = format;
+  // Keeps the capacity if the frame gets smaller
+  frame.data.resize( static_cast<size_t>( frame.width ) * frame.height *
+                     ImageStreamFrame::bytesPerPixel( format ) );
+  return FrameWriter( this, std::move( lock ), &frame );
+}
+
+void ImageStream::publish( const void *data, int width, int height, int stride,
+                           ImageStreamFrame::Format format )
+{
+  FrameWriter writer = beginFrame( width, height, format );
+  const int row_size = writer.stride();
+  const auto *source = static_cast<const unsigned char *>( data );
+  if ( stride == row_size ) {
+    std::memcpy( writer.data(), source, static_cast<size_t>( row_size ) * height );
+    return;
+  }
+  for ( int row = 0; row < height; ++row )
+    std::memcpy( writer.data() + static_cast<size_t>( row ) * row_size,
+                 source + static_cast<size_t>( row ) * stride, row_size );
+}
+
+void ImageStream::publish()
+{
+  // Called with the producer mutex held
+  ImageStreamFrame &frame = frames_[back_index_];
+  frame.sequence = ++sequence_;
+  width_.store( frame.width, std::memory_order_relaxed );
+  height_.store( frame.height, std::memory_order_relaxed );
+  int previous = shared_index_.exchange( back_index_ | NewFrameFlag, std::memory_order_acq_rel );
+  // If the previous frame was never acquired, it is dropped and overwritten by the next frame
+  back_index_ = previous & IndexMask;
+
+  if ( notification_pending_.exchange( true, std::memory_order_acq_rel ) )
+    return;
+  std::lock_guard<std::mutex> lock( listener_mutex_ );
+  for ( QObject *listener : listeners_ )
+    QMetaObject::invokeMethod( listener, "onFrameAvailable", Qt::QueuedConnection );
+}
+
+QSize ImageStream::size() const
+{
+  return { width_.load( std::memory_order_relaxed ), height_.load( std::memory_order_relaxed ) };
+}
+
+const ImageStreamFrame *ImageStream::acquireLatest()
+{
+  // Reset before picking up the frame, so that a frame published in the meantime notifies the
+  // listeners again. A notification for a frame picked up here only causes a redundant update.
+  notification_pending_.store( false, std::memory_order_release );
+  if ( shared_index_.load( std::memory_order_acquire ) & NewFrameFlag ) {
+    int previous = shared_index_.exchange( front_index_, std::memory_order_acq_rel );
+    front_index_ = previous & IndexMask;
+  }
+  const ImageStreamFrame &frame = frames_[front_index_];
+  return frame.sequence == 0 ? nullptr : &frame;
+}
+
+void ImageStream::addListener( QObject *listener )
+{
+  std::lock_guard<std::mutex> lock( listener_mutex_ );
+  if ( std::find( listeners_.begin(), listeners_.end(), listener ) == listeners_.end() )
+    listeners_.push_back( listener );
+}
+
+void ImageStream::removeListener( QObject *listener )
+{
+  std::lock_guard<std::mutex> lock( listener_mutex_ );
+  listeners_.erase( std::remove( listeners_.begin(), listeners_.end(), listener ),
+                    listeners_.end() );
+}
+} // namespace hector_rviz_overlay
@@ -0,0 +1,366 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/qml/image_stream_item.hpp"
+
+#include "hector_rviz_overlay/qml/image_stream.hpp"
+
+#include <QOpenGLBuffer>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QQuickWindow>
+#include <QRunnable>
+#include <QSGSimpleTextureNode>
+#include <QSGTexture>
+#include <QSGTextureProvider>
+
+#include <cstring>
+
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_BGR
+#define GL_BGR 0x80E0
+#endif
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_R8
+#define GL_R8 0x8229
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_G
+#define GL_TEXTURE_SWIZZLE_G 0x8E43
+#endif
+#ifndef GL_TEXTURE_SWIZZLE_B
+#define GL_TEXTURE_SWIZZLE_B 0x8E44
+#endif
+
+namespace hector_rviz_overlay
+{
+
+namespace
+{
+/*!
+ * A texture that is allocated once and updated in place with the frames of an ImageStream.
+ * Only accessed on the render thread.
+ */
+class ImageStreamTexture : public QSGTexture
+{
+public:
+  ~ImageStreamTexture() override
+  {
+    // The context is shared with Ogre and outlives the scene graph, hence, the GL objects are not
+    // deleted with it and have to be released on the render thread before the texture is deleted
+    Q_ASSERT( texture_id_ == 0 && !pixel_buffer_.isCreated() );
+  }
+
+  //! Deletes the texture and the pixel buffer. Has to be called on the render thread.
+  void releaseGlResources()
+  {
+    if ( texture_id_ == 0 && !pixel_buffer_.isCreated() )
+      return;
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    Q_ASSERT( context != nullptr );
+    if ( texture_id_ != 0 )
+      context->functions()->glDeleteTextures( 1, &texture_id_ );
+    texture_id_ = 0;
+    pixel_buffer_.destroy();
+    size_ = QSize();
+    internal_format_ = 0;
+    sequence_ = 0;
+  }
+
+  int textureId() const override { return static_cast<int>( texture_id_ ); }
+
+  QSize textureSize() const override { return size_; }
+
+  bool hasAlphaChannel() const override { return has_alpha_; }
+
+  bool hasMipmaps() const override { return false; }
+
+  void bind() override
+  {
+    QOpenGLContext::currentContext()->functions()->glBindTexture( GL_TEXTURE_2D, texture_id_ );
+    updateBindOptions( bind_options_dirty_ );
+    bind_options_dirty_ = false;
+  }
+
+  //! @return The sequence number of the uploaded frame or 0 if no frame was uploaded yet.
+  uint64_t sequence() const { return sequence_; }
+
+  void upload( QOpenGLContext *context, const ImageStreamFrame &frame )
+  {
+    QOpenGLFunctions *functions = context->functions();
+    const bool core_profile = context->format().profile() == QSurfaceFormat::CoreProfile;
+    GLint internal_format = GL_RGBA;
+    GLenum format = GL_RGBA;
+    switch ( frame.format ) {
+    case ImageStreamFrame::Rgba8:
+      break;
+    case ImageStreamFrame::Bgra8:
+      format = GL_BGRA;
+      break;
+    case ImageStreamFrame::Rgb8:
+      internal_format = GL_RGB;
+      format = GL_RGB;
+      break;
+    case ImageStreamFrame::Bgr8:
+      internal_format = GL_RGB;
+      format = GL_BGR;
+      break;
+    case ImageStreamFrame::Mono8:
+      // Luminance textures were removed from the core profile
+      internal_format = core_profile ? GL_R8 : GL_LUMINANCE;
+      format = core_profile ? GL_RED : GL_LUMINANCE;
+      break;
+    }
+
+    if ( texture_id_ == 0 )
+      functions->glGenTextures( 1, &texture_id_ );
+    functions->glBindTexture( GL_TEXTURE_2D, texture_id_ );
+    GLint unpack_alignment = 4;
+    functions->glGetIntegerv( GL_UNPACK_ALIGNMENT, &unpack_alignment );
+    functions->glPixelStorei( GL_UNPACK_ALIGNMENT, 1 );
+
+    const QSize size( frame.width, frame.height );
+    if ( size != size_ || internal_format != internal_format_ ) {
+      // The storage is only (re)allocated if the size or format of the stream changes
+      functions->glTexImage2D( GL_TEXTURE_2D, 0, internal_format, frame.width, frame.height, 0,
+                               format, GL_UNSIGNED_BYTE, nullptr );
+      if ( internal_format == GL_R8 ) {
+        functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, GL_RED );
+        functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, GL_RED );
+      }
+      size_ = size;
+      internal_format_ = internal_format;
+      has_alpha_ =
+          frame.format == ImageStreamFrame::Rgba8 || frame.format == ImageStreamFrame::Bgra8;
+      bind_options_dirty_ = true;
+    }
+
+    const bool use_pbo = context->format().majorVersion() >= 3 ||
+                         context->hasExtension( QByteArrayLiteral( "GL_ARB_pixel_buffer_object" ) );
+    if ( use_pbo ) {
+      if ( !pixel_buffer_.isCreated() ) {
+        pixel_buffer_.create();
+        pixel_buffer_.setUsagePattern( QOpenGLBuffer::StreamDraw );
+      }
+      pixel_buffer_.bind();
+      // Respecifying the storage without data orphans the buffer of the previous frame, hence,
+      // mapping does not wait for the previous transfer to the texture to finish
+      const int data_size = static_cast<int>( frame.data.size() );
+      pixel_buffer_.allocate( data_size );
+      const bool map_range =
+          context->format().majorVersion() >= 3 ||
+          context->hasExtension( QByteArrayLiteral( "GL_ARB_map_buffer_range" ) );
+      void *mapped =
+          map_range ? pixel_buffer_.mapRange( 0, data_size,
+                                              QOpenGLBuffer::RangeWrite |
+                                                  QOpenGLBuffer::RangeInvalidateBuffer )
+                    : pixel_buffer_.map( QOpenGLBuffer::WriteOnly );
+      if ( mapped != nullptr ) {
+        std::memcpy( mapped, frame.data.data(), frame.data.size() );
+        pixel_buffer_.unmap();
+      } else {
+        pixel_buffer_.write( 0, frame.data.data(), data_size );
+      }
+      functions->glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, frame.width, frame.height, format,
+                                  GL_UNSIGNED_BYTE, nullptr );
+      pixel_buffer_.release();
+    } else {
+      functions->glTexSubImage2D( GL_TEXTURE_2D, 0, 0, 0, frame.width, frame.height, format,
+                                  GL_UNSIGNED_BYTE, frame.data.data() );
+    }
+    functions->glPixelStorei( GL_UNPACK_ALIGNMENT, unpack_alignment );
+    sequence_ = frame.sequence;
+  }
+
+private:
+  QOpenGLBuffer pixel_buffer_{ QOpenGLBuffer::PixelUnpackBuffer };
+  GLuint texture_id_ = 0;
+  GLint internal_format_ = 0;
+  QSize size_;
+  uint64_t sequence_ = 0;
+  bool has_alpha_ = false;
+  bool bind_options_dirty_ = true;
+};
+
+} // namespace
+
+class ImageStreamTextureProvider : public QSGTextureProvider
+{
+public:
+  //! Releases the GL resources of the texture and deletes the provider on the render thread.
+  void destroy()
+  {
+    texture_.releaseGlResources();
+    delete this;
+  }
+
+  QSGTexture *texture() const override
+  {
+    return texture_.sequence() == 0 ? nullptr : const_cast<ImageStreamTexture *>( &texture_ );
+  }
+
+  ImageStreamTexture &streamTexture() { return texture_; }
+
+private:
+  ImageStreamTexture texture_;
+};
+
+namespace
+{
+class ProviderCleanupJob : public QRunnable
+{
+public:
+  explicit ProviderCleanupJob( ImageStreamTextureProvider *provider ) : provider_( provider ) { }
+
+  void run() override { provider_->destroy(); }
+
+private:
+  ImageStreamTextureProvider *provider_;
+};
+} // namespace
+
+ImageStreamItem::ImageStreamItem( QQuickItem *parent ) : QQuickItem( parent )
+{
+  setFlag( ItemHasContents );
+}
+
+ImageStreamItem::~ImageStreamItem()
+{
+  if ( stream_ != nullptr )
+    stream_->removeListener( this );
+  // Usually, the provider was already handed to the render thread when the item was removed from
+  // its window. Otherwise, nothing was uploaded since the scene graph was invalidated
+  releaseResources();
+  if ( provider_ != nullptr )
+    provider_->destroy();
+}
+
+void ImageStreamItem::setStream( const QString &value )
+{
+  if ( value == stream_name_ )
+    return;
+  if ( stream_ != nullptr )
+    stream_->removeListener( this );
+  stream_name_ = value;
+  stream_ = value.isEmpty() ? nullptr : ImageStream::get( value );
+  if ( stream_ != nullptr )
+    stream_->addListener( this );
+  emit streamChanged();
+  onFrameAvailable();
+}
+
+void ImageStreamItem::setFillMode( FillMode value )
+{
+  if ( value == fill_mode_ )
+    return;
+  fill_mode_ = value;
+  emit fillModeChanged();
+  update();
+}
+
+QSGTextureProvider *ImageStreamItem::textureProvider() const
+{
+  if ( provider_ == nullptr )
+    provider_ = new ImageStreamTextureProvider;
+  return provider_;
+}
+
+void ImageStreamItem::onFrameAvailable()
+{
+  const QSize size = stream_ != nullptr ? stream_->size() : QSize();
+  if ( size != source_size_ ) {
+    source_size_ = size;
+    emit sourceSizeChanged();
+  }
+  update();
+}
+
+QSGNode *ImageStreamItem::updatePaintNode( QSGNode *old_node, UpdatePaintNodeData * )
+{
+  auto *node = static_cast<QSGSimpleTextureNode *>( old_node );
+  textureProvider();
+  ImageStreamTexture &texture = provider_->streamTexture();
+  const ImageStreamFrame *frame = stream_ != nullptr ? stream_->acquireLatest() : nullptr;
+  bool uploaded = false;
+  if ( frame != nullptr && frame->sequence != texture.sequence() && !frame->data.empty() ) {
+    texture.upload( QOpenGLContext::currentContext(), *frame );
+    uploaded = true;
+  }
+  if ( texture.sequence() == 0 || width() <= 0 || height() <= 0 ) {
+    delete node;
+    return nullptr;
+  }
+  if ( node == nullptr ) {
+    node = new QSGSimpleTextureNode;
+    // The texture is owned by the provider since it is shared with consumers of the provider
+    node->setOwnsTexture( false );
+  }
+  node->setTexture( &texture );
+  node->setFiltering( smooth() ? QSGTexture::Linear : QSGTexture::Nearest );
+
+  const QSizeF texture_size = texture.textureSize();
+  const QRectF bounds = boundingRect();
+  QRectF rect = bounds;
+  QRectF source_rect( QPointF( 0, 0 ), texture_size );
+  if ( fill_mode_ == PreserveAspectFit ) {
+    QSizeF size = texture_size.scaled( bounds.size(), Qt::KeepAspectRatio );
+    rect = QRectF( bounds.center() - QPointF( size.width() / 2, size.height() / 2 ), size );
+  } else if ( fill_mode_ == PreserveAspectCrop ) {
+    QSizeF size = bounds.size().scaled( texture_size, Qt::KeepAspectRatio );
+    source_rect = QRectF( QPointF( ( texture_size.width() - size.width() ) / 2,
+                                   ( texture_size.height() - size.height() ) / 2 ),
+                          size );
+  }
+  node->setRect( rect );
+  node->setSourceRect( source_rect );
+  if ( uploaded ) {
+    node->markDirty( QSGNode::DirtyMaterial );
+    emit provider_->textureChanged();
+  }
+  return node;
+}
+
+void ImageStreamItem::itemChange( ItemChange change, const ItemChangeData &value )
+{
+  if ( change == ItemSceneChange && value.window != nullptr ) {
+    connect( value.window, &QQuickWindow::sceneGraphInvalidated, this,
+             &ImageStreamItem::invalidateSceneGraph,
+             static_cast<Qt::ConnectionType>( Qt::DirectConnection | Qt::UniqueConnection ) );
+  }
+  QQuickItem::itemChange( change, value );
+}
+
+void ImageStreamItem::invalidateSceneGraph()
+{
+  // Called on the render thread with the context current
+  if ( provider_ != nullptr )
+    provider_->destroy();
+  provider_ = nullptr;
+}
+
+void ImageStreamItem::releaseResources()
+{
+  if ( provider_ == nullptr || window() == nullptr )
+    return;
+  window()->scheduleRenderJob( new ProviderCleanupJob( provider_ ),
+                               QQuickWindow::BeforeSynchronizingStage );
+  provider_ = nullptr;
+}
+} // namespace hector_rviz_overlay
@@ -0,0 +1,37 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/qml/qml_types.hpp"
+
+#include "hector_rviz_overlay/qml/image_stream_item.hpp"
+#include "hector_rviz_overlay/qml/time_series_plot.hpp"
+
+#include <QQmlEngine>
+
+namespace hector_rviz_overlay
+{
+
+void registerQmlTypes()
+{
+  static bool registered = false;
+  if ( registered )
+    return;
+  registered = true;
+  qmlRegisterType<ImageStreamItem>( "Hector.RvizOverlay", 1, 0, "ImageStream" );
+  qmlRegisterType<TimeSeriesPlot>( "Hector.RvizOverlay", 1, 0, "TimeSeriesPlot" );
+}
+} // namespace hector_rviz_overlay
@@ -0,0 +1,555 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/qml/time_series_plot.hpp"
+
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QSGTransformNode>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace hector_rviz_overlay
+{
+
+namespace
+{
+constexpr int64_t NoBucket = std::numeric_limits<int64_t>::min();
+}
+
+TimeSeriesChannel::TimeSeriesChannel( TimeSeriesPlot *plot )
+    : queue_( QueueCapacity ), plot_( plot )
+{
+}
+
+bool TimeSeriesChannel::append( double time, double value )
+{
+  if ( !queue_.tryPush( TimeSeriesSample{ time, value } ) )
+    return false;
+  // Only the first sample after the plot drained the queue has to notify the plot
+  if ( !update_pending_.exchange( true, std::memory_order_acq_rel ) ) {
+    std::lock_guard<std::mutex> lock( plot_mutex_ );
+    if ( plot_ != nullptr )
+      QMetaObject::invokeMethod( plot_, "onSamplesAvailable", Qt::QueuedConnection );
+  }
+  return true;
+}
+
+struct TimeSeriesPlot::ChannelData {
+  std::shared_ptr<TimeSeriesChannel> channel;
+  QString name;
+  QColor color;
+  float line_width = 1;
+
+  //! Ring buffer of the raw samples sorted by time.
+  std::vector<TimeSeriesSample> history;
+  size_t history_start = 0;
+  size_t history_size = 0;
+
+  //! The decimated vertices. x is the bucket relative to base_bucket and y the value.
+  std::vector<QSGGeometry::Point2D> vertices;
+  int64_t base_bucket = 0;
+  //! The bucket the last two vertices belong to in MinMax mode. It may still receive samples.
+  int64_t open_bucket = NoBucket;
+  float open_min = 0;
+  float open_max = 0;
+  bool open_min_first = true;
+  bool lttb_outdated = false;
+
+  // Computed in updatePolish and used in updatePaintNode
+  size_t first_visible = 0;
+  float start_x = 0;
+  bool geometry_dirty = true;
+  bool material_dirty = true;
+
+  const TimeSeriesSample &sample( size_t index ) const
+  {
+    return history[( history_start + index ) % history.size()];
+  }
+
+  void push( const TimeSeriesSample &value )
+  {
+    const size_t capacity = history.size();
+    if ( history_size < capacity ) {
+      history[( history_start + history_size ) % capacity] = value;
+      ++history_size;
+      return;
+    }
+    history[history_start] = value;
+    history_start = ( history_start + 1 ) % capacity;
+  }
+
+  //! @return The index of the first sample with a time greater or equal to the given time.
+  size_t lowerBound( double time ) const
+  {
+    size_t first = 0, count = history_size;
+    while ( count > 0 ) {
+      size_t step = count / 2;
+      if ( sample( first + step ).time < time ) {
+        first += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    return first;
+  }
+};
+
+TimeSeriesPlot::TimeSeriesPlot( QQuickItem *parent ) : QQuickItem( parent )
+{
+  setFlag( ItemHasContents );
+  setClip( true );
+}
+
+TimeSeriesPlot::~TimeSeriesPlot()
+{
+  for ( auto &channel : channels_ ) {
+    std::lock_guard<std::mutex> lock( channel->channel->plot_mutex_ );
+    channel->channel->plot_ = nullptr;
+  }
+}
+
+void TimeSeriesPlot::setTimeWindow( double value )
+{
+  if ( value <= 0 || value == time_window_ )
+    return;
+  time_window_ = value;
+  emit timeWindowChanged();
+  requestRebuild();
+}
+
+void TimeSeriesPlot::setAutoScale( bool value )
+{
+  if ( value == auto_scale_ )
+    return;
+  auto_scale_ = value;
+  emit autoScaleChanged();
+  polish();
+  update();
+}
+
+void TimeSeriesPlot::setMinimum( double value )
+{
+  if ( value == minimum_ )
+    return;
+  minimum_ = value;
+  emit minimumChanged();
+  polish();
+  update();
+}
+
+void TimeSeriesPlot::setMaximum( double value )
+{
+  if ( value == maximum_ )
+    return;
+  maximum_ = value;
+  emit maximumChanged();
+  polish();
+  update();
+}
+
+void TimeSeriesPlot::setCapacity( int value )
+{
+  if ( value < 1 || value == capacity_ )
+    return;
+  capacity_ = value;
+  for ( auto &channel : channels_ ) {
+    // Keep the newest samples
+    std::vector<TimeSeriesSample> history( capacity_ );
+    const size_t keep = std::min( channel->history_size, history.size() );
+    for ( size_t i = 0; i < keep; ++i )
+      history[i] = channel->sample( channel->history_size - keep + i );
+    channel->history.swap( history );
+    channel->history_start = 0;
+    channel->history_size = keep;
+  }
+  emit capacityChanged();
+  requestRebuild();
+}
+
+void TimeSeriesPlot::setDecimation( Decimation value )
+{
+  if ( value == decimation_ )
+    return;
+  decimation_ = value;
+  emit decimationChanged();
+  requestRebuild();
+}
+
+int TimeSeriesPlot::addChannel( const QString &name, const QColor &color, qreal line_width )
+{
+  auto data = std::make_unique<ChannelData>();
+  data->channel = std::shared_ptr<TimeSeriesChannel>( new TimeSeriesChannel( this ) );
+  data->name = name;
+  data->color = color;
+  data->line_width = static_cast<float>( line_width );
+  data->history.resize( capacity_ );
+  data->vertices.reserve( vertexBudget() );
+  channels_.push_back( std::move( data ) );
+  emit channelCountChanged();
+  polish();
+  update();
+  return channelCount() - 1;
+}
+
+void TimeSeriesPlot::append( int channel, double time, double value )
+{
+  if ( channel < 0 || channel >= channelCount() )
+    return;
+  channels_[channel]->channel->append( time, value );
+}
+
+void TimeSeriesPlot::clear()
+{
+  for ( auto &channel : channels_ ) {
+    channel->history_start = 0;
+    channel->history_size = 0;
+    channel->vertices.clear();
+    channel->open_bucket = NoBucket;
+    channel->geometry_dirty = true;
+  }
+  latest_time_ = -std::numeric_limits<double>::infinity();
+  polish();
+  update();
+}
+
+std::shared_ptr<TimeSeriesChannel> TimeSeriesPlot::channel( int index ) const
+{
+  if ( index < 0 || index >= channelCount() )
+    return nullptr;
+  return channels_[index]->channel;
+}
+
+std::shared_ptr<TimeSeriesChannel> TimeSeriesPlot::channel( const QString &name ) const
+{
+  for ( const auto &channel : channels_ ) {
+    if ( channel->name == name )
+      return channel->channel;
+  }
+  return nullptr;
+}
+
+void TimeSeriesPlot::onSamplesAvailable()
+{
+  polish();
+  update();
+}
+
+void TimeSeriesPlot::geometryChanged( const QRectF &new_geometry, const QRectF &old_geometry )
+{
+  QQuickItem::geometryChanged( new_geometry, old_geometry );
+  if ( std::ceil( new_geometry.width() ) != std::ceil( old_geometry.width() ) )
+    requestRebuild();
+  else if ( new_geometry.height() != old_geometry.height() )
+    update();
+}
+
+void TimeSeriesPlot::requestRebuild()
+{
+  rebuild_required_ = true;
+  polish();
+  update();
+}
+
+void TimeSeriesPlot::rebuild()
+{
+  rebuild_required_ = false;
+  bucket_count_ = std::max( 1, static_cast<int>( std::ceil( width() ) ) );
+  bucket_duration_ = time_window_ / bucket_count_;
+  // One additional bucket to the left of the window so that the line enters the plot at the border
+  const double window_start = latest_time_ - time_window_ - bucket_duration_;
+  for ( auto &channel : channels_ ) {
+    channel->vertices.clear();
+    channel->vertices.reserve( vertexBudget() );
+    channel->open_bucket = NoBucket;
+    channel->geometry_dirty = true;
+    if ( decimation_ == Lttb ) {
+      channel->lttb_outdated = true;
+      continue;
+    }
+    for ( size_t i = channel->lowerBound( window_start ); i < channel->history_size; ++i )
+      appendToMinMax( *channel, channel->sample( i ) );
+  }
+}
+
+void TimeSeriesPlot::appendToMinMax( ChannelData &channel, const TimeSeriesSample &sample )
+{
+  const auto value = static_cast<float>( sample.value );
+  const auto bucket = static_cast<int64_t>( std::floor( sample.time / bucket_duration_ ) );
+  if ( channel.open_bucket != NoBucket && bucket <= channel.open_bucket ) {
+    if ( value < channel.open_min ) {
+      channel.open_min = value;
+      channel.open_min_first = false;
+    } else if ( value > channel.open_max ) {
+      channel.open_max = value;
+      channel.open_min_first = true;
+    } else {
+      return;
+    }
+    // Only the two vertices of the open bucket change
+    QSGGeometry::Point2D *last = channel.vertices.data() + channel.vertices.size() - 2;
+    last[0].y = channel.open_min_first ? channel.open_min : channel.open_max;
+    last[1].y = channel.open_min_first ? channel.open_max : channel.open_min;
+    return;
+  }
+
+  if ( channel.vertices.empty() ) {
+    channel.base_bucket = bucket;
+  } else if ( channel.vertices.size() + 2 > vertexBudget() ||
+              bucket - channel.base_bucket > static_cast<int64_t>( vertexBudget() ) ) {
+    compact( channel, bucket );
+  }
+  const auto x = static_cast<float>( bucket - channel.base_bucket );
+  channel.vertices.push_back( { x, value } );
+  channel.vertices.push_back( { x, value } );
+  channel.open_bucket = bucket;
+  channel.open_min = channel.open_max = value;
+  channel.open_min_first = true;
+}
+
+void TimeSeriesPlot::compact( ChannelData &channel, int64_t latest_bucket )
+{
+  // Drop the vertices left of the window except for the bucket that connects to the first visible
+  const auto first_needed =
+      static_cast<float>( latest_bucket - bucket_count_ - channel.base_bucket );
+  auto &vertices = channel.vertices;
+  auto first = std::lower_bound(
+      vertices.begin(), vertices.end(), first_needed,
+      []( const QSGGeometry::Point2D &vertex, float x ) { return vertex.x < x; } );
+  if ( first == vertices.end() ) {
+    vertices.clear();
+    channel.base_bucket = latest_bucket;
+    return;
+  }
+  // Rebase so that the coordinates stay small enough to be represented exactly as floats
+  const auto offset = static_cast<int64_t>( first->x );
+  vertices.erase( vertices.begin(), first );
+  for ( auto &vertex : vertices ) vertex.x -= static_cast<float>( offset );
+  channel.base_bucket += offset;
+}
+
+void TimeSeriesPlot::computeLttb( ChannelData &channel )
+{
+  channel.lttb_outdated = false;
+  channel.vertices.clear();
+  if ( channel.history_size == 0 )
+    return;
+  const size_t first = channel.lowerBound( latest_time_ - time_window_ - bucket_duration_ );
+  const size_t n = channel.history_size - first;
+  if ( n == 0 )
+    return;
+  channel.base_bucket =
+      static_cast<int64_t>( std::floor( channel.sample( first ).time / bucket_duration_ ) );
+  const double base = static_cast<double>( channel.base_bucket );
+  auto x_at = [&]( size_t i ) {
+    return channel.sample( first + i ).time / bucket_duration_ - base;
+  };
+  auto y_at = [&]( size_t i ) { return channel.sample( first + i ).value; };
+  auto push = [&]( size_t i ) {
+    channel.vertices.push_back(
+        { static_cast<float>( x_at( i ) ), static_cast<float>( y_at( i ) ) } );
+  };
+
+  const size_t threshold = 2 * static_cast<size_t>( bucket_count_ );
+  if ( n <= threshold || threshold < 3 ) {
+    for ( size_t i = 0; i < n; ++i ) push( i );
+    return;
+  }
+
+  // Always keeps the first and the last sample and selects the sample forming the largest triangle
+  // with the previously selected sample and the average of the next bucket in between.
+  const double every = static_cast<double>( n - 2 ) / static_cast<double>( threshold - 2 );
+  size_t a = 0;
+  push( a );
+  for ( size_t i = 0; i < threshold - 2; ++i ) {
+    size_t avg_start = static_cast<size_t>( std::floor( ( i + 1 ) * every ) ) + 1;
+    size_t avg_end = std::min( static_cast<size_t>( std::floor( ( i + 2 ) * every ) ) + 1, n );
+    avg_start = std::min( avg_start, n - 1 );
+    avg_end = std::max( avg_end, avg_start + 1 );
+    double avg_x = 0, avg_y = 0;
+    for ( size_t j = avg_start; j < avg_end; ++j ) {
+      avg_x += x_at( j );
+      avg_y += y_at( j );
+    }
+    avg_x /= static_cast<double>( avg_end - avg_start );
+    avg_y /= static_cast<double>( avg_end - avg_start );
+
+    const size_t range_start = static_cast<size_t>( std::floor( i * every ) ) + 1;
+    const size_t range_end =
+        std::min( static_cast<size_t>( std::floor( ( i + 1 ) * every ) ) + 1, n - 1 );
+    const double a_x = x_at( a ), a_y = y_at( a );
+    double max_area = -1;
+    size_t next = range_start;
+    for ( size_t j = range_start; j < range_end; ++j ) {
+      double area =
+          std::abs( ( a_x - avg_x ) * ( y_at( j ) - a_y ) - ( a_x - x_at( j ) ) * ( avg_y - a_y ) );
+      if ( area > max_area ) {
+        max_area = area;
+        next = j;
+      }
+    }
+    push( next );
+    a = next;
+  }
+  push( n - 1 );
+}
+
+void TimeSeriesPlot::updatePolish()
+{
+  if ( rebuild_required_ )
+    rebuild();
+
+  for ( auto &channel : channels_ ) {
+    // Reset before draining so that samples appended in the meantime notify the plot again
+    channel->channel->update_pending_.store( false, std::memory_order_release );
+    TimeSeriesSample sample;
+    for ( size_t i = 0; i < TimeSeriesChannel::QueueCapacity &&
+                        channel->channel->queue_.tryPop( sample );
+          ++i ) {
+      if ( channel->history_size > 0 ) {
+        const double last_time = channel->sample( channel->history_size - 1 ).time;
+        sample.time = std::max( sample.time, last_time );
+      }
+      channel->push( sample );
+      latest_time_ = std::max( latest_time_, sample.time );
+      if ( decimation_ == MinMax )
+        appendToMinMax( *channel, sample );
+      else
+        channel->lttb_outdated = true;
+      channel->geometry_dirty = true;
+    }
+    if ( channel->lttb_outdated )
+      computeLttb( *channel );
+  }
+  updateVisibleRange();
+}
+
+void TimeSeriesPlot::updateVisibleRange()
+{
+  float low = std::numeric_limits<float>::max();
+  float high = std::numeric_limits<float>::lowest();
+  if ( !channels_.empty() && std::isfinite( latest_time_ ) ) {
+    const auto latest_bucket =
+        static_cast<int64_t>( std::floor( latest_time_ / bucket_duration_ ) );
+    const int64_t start_bucket = latest_bucket + 1 - bucket_count_;
+    for ( auto &channel : channels_ ) {
+      const auto &vertices = channel->vertices;
+      channel->start_x = static_cast<float>( start_bucket - channel->base_bucket );
+      auto visible = std::lower_bound(
+          vertices.begin(), vertices.end(), channel->start_x,
+          []( const QSGGeometry::Point2D &vertex, float x ) { return vertex.x < x; } );
+      for ( auto it = visible; it != vertices.end(); ++it ) {
+        low = std::min( low, it->y );
+        high = std::max( high, it->y );
+      }
+      // Include the last vertex left of the window to connect to the first visible vertex
+      size_t first_visible = visible - vertices.begin();
+      if ( first_visible > 0 )
+        --first_visible;
+      if ( first_visible != channel->first_visible ) {
+        channel->first_visible = first_visible;
+        channel->geometry_dirty = true;
+      }
+    }
+  }
+
+  double displayed_minimum = minimum_;
+  double displayed_maximum = maximum_;
+  if ( auto_scale_ ) {
+    if ( low > high ) {
+      // No visible samples, keep the current range
+      displayed_minimum = displayed_minimum_;
+      displayed_maximum = displayed_maximum_;
+    } else {
+      double margin = 0.05 * ( high - low );
+      if ( margin <= 0 )
+        margin = std::max( 0.05 * std::abs( low ), 0.5 );
+      displayed_minimum = low - margin;
+      displayed_maximum = high + margin;
+    }
+  }
+  if ( displayed_maximum <= displayed_minimum )
+    displayed_maximum = displayed_minimum + 1;
+  if ( displayed_minimum == displayed_minimum_ && displayed_maximum == displayed_maximum_ )
+    return;
+  displayed_minimum_ = displayed_minimum;
+  displayed_maximum_ = displayed_maximum;
+  emit displayedRangeChanged();
+}
+
+QSGNode *TimeSeriesPlot::updatePaintNode( QSGNode *old_node, UpdatePaintNodeData * )
+{
+  if ( channels_.empty() || width() <= 0 || height() <= 0 ) {
+    delete old_node;
+    return nullptr;
+  }
+  QSGNode *root = old_node != nullptr ? old_node : new QSGNode;
+  // Channels are never removed, hence, the existing nodes still belong to the same channels
+  while ( root->childCount() < channelCount() ) {
+    auto *geometry = new QSGGeometry( QSGGeometry::defaultAttributes_Point2D(), 0 );
+    geometry->setDrawingMode( QSGGeometry::DrawLineStrip );
+    geometry->setVertexDataPattern( QSGGeometry::StreamPattern );
+    auto *node = new QSGGeometryNode;
+    node->setGeometry( geometry );
+    node->setFlag( QSGNode::OwnsGeometry );
+    node->setMaterial( new QSGFlatColorMaterial );
+    node->setFlag( QSGNode::OwnsMaterial );
+    auto *transform = new QSGTransformNode;
+    transform->appendChildNode( node );
+    root->appendChildNode( transform );
+    channels_[root->childCount() - 1]->material_dirty = true;
+    channels_[root->childCount() - 1]->geometry_dirty = true;
+  }
+
+  // Maps the bucket coordinates to pixel columns and the values to the item's height
+  const double x_scale = width() / bucket_count_;
+  const double y_scale = -height() / ( displayed_maximum_ - displayed_minimum_ );
+  const double y_offset = height() - displayed_minimum_ * y_scale;
+  QSGNode *child = root->firstChild();
+  for ( auto &channel : channels_ ) {
+    auto *transform = static_cast<QSGTransformNode *>( child );
+    auto *node = static_cast<QSGGeometryNode *>( transform->firstChild() );
+    child = child->nextSibling();
+
+    transform->setMatrix( QMatrix4x4( x_scale, 0, 0, -channel->start_x * x_scale, 0, y_scale, 0,
+                                      y_offset, 0, 0, 1, 0, 0, 0, 0, 1 ) );
+    if ( channel->material_dirty ) {
+      static_cast<QSGFlatColorMaterial *>( node->material() )->setColor( channel->color );
+      node->geometry()->setLineWidth( channel->line_width );
+      node->markDirty( QSGNode::DirtyMaterial );
+      channel->material_dirty = false;
+    }
+    if ( !channel->geometry_dirty )
+      continue;
+    QSGGeometry *geometry = node->geometry();
+    const size_t first = std::min( channel->first_visible, channel->vertices.size() );
+    const int count = static_cast<int>( channel->vertices.size() - first );
+    // Only reallocates if the number of visible vertices changed
+    if ( geometry->vertexCount() != count )
+      geometry->allocate( count );
+    if ( count > 0 )
+      std::memcpy( geometry->vertexDataAsPoint2D(), channel->vertices.data() + first,
+                   count * sizeof( QSGGeometry::Point2D ) );
+    node->markDirty( QSGNode::DirtyGeometry );
+    channel->geometry_dirty = false;
+  }
+  return root;
+}
+} // namespace hector_rviz_overlay
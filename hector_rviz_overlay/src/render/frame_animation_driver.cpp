@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/render/frame_animation_driver.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace hector_rviz_overlay
+{
+namespace
+{
+// If no frame was rendered for this long, the FrameSynced mode falls back to the wall-clock
+constexpr int FallbackDelayMs = 100;
+constexpr int FallbackIntervalMs = 16;
+// Maximum step after a pause so that animations continue where they left off instead of jumping
+constexpr qint64 MaxPausingStepNs = 100 * 1000000LL;
+constexpr qint64 NsPerMs = 1000000;
+
+FrameAnimationDriver *driver_instance = nullptr;
+int driver_ref_count = 0;
+FrameAnimationDriver::Mode driver_mode = FrameAnimationDriver::FrameSynced;
+float driver_max_tick_rate = 0;
+bool driver_paused = false;
+} // namespace
+
+FrameAnimationDriver::FrameAnimationDriver()
+{
+  wall_clock_.start();
+  // Single-shot timer that is pushed back by every frame, i.e., it only fires once frames stopped
+  fallback_timer_.setSingleShot( true );
+  connect( &fallback_timer_, &QTimer::timeout, this, &FrameAnimationDriver::onFallbackTimeout );
+}
+
+void FrameAnimationDriver::acquire()
+{
+  ++driver_ref_count;
+  updateInstallation();
+}
+
+void FrameAnimationDriver::release()
+{
+  if ( driver_ref_count == 0 )
+    return;
+  --driver_ref_count;
+  updateInstallation();
+}
+
+void FrameAnimationDriver::updateInstallation()
+{
+  bool should_be_installed = driver_ref_count > 0 && driver_mode != WallClock;
+  if ( should_be_installed == ( driver_instance != nullptr ) )
+    return;
+  if ( should_be_installed ) {
+    driver_instance = new FrameAnimationDriver;
+    driver_instance->install();
+    return;
+  }
+  driver_instance->uninstall();
+  delete driver_instance;
+  driver_instance = nullptr;
+}
+
+void FrameAnimationDriver::advanceFrame( float dt )
+{
+  if ( driver_instance == nullptr )
+    return;
+  driver_instance->advanceBy( std::llround( static_cast<double>( dt ) * 1E9 ) );
+}
+
+FrameAnimationDriver::Mode FrameAnimationDriver::mode() { return driver_mode; }
+
+void FrameAnimationDriver::setMode( Mode value )
+{
+  driver_mode = value;
+  updateInstallation();
+  if ( driver_instance == nullptr )
+    return;
+  driver_instance->fallback_timer_.stop();
+  driver_instance->restartFallbackTimer( FallbackDelayMs );
+}
+
+void FrameAnimationDriver::setMaxTickRate( float value )
+{
+  driver_max_tick_rate = value < 0 ? 0 : value;
+}
+
+void FrameAnimationDriver::setPaused( bool value )
+{
+  if ( driver_paused == value )
+    return;
+  driver_paused = value;
+  if ( driver_paused || driver_instance == nullptr )
+    return;
+  // Continue where we left off instead of catching up on the time spent paused
+  driver_instance->last_tick_wall_ns_ = driver_instance->wall_clock_.nsecsElapsed();
+  driver_instance->restartFallbackTimer( FallbackDelayMs );
+}
+
+qint64 FrameAnimationDriver::elapsed() const { return elapsed_ns_ / NsPerMs; }
+
+void FrameAnimationDriver::start()
+{
+  // Like Qt's default driver, the elapsed time is relative to the start of the driver
+  elapsed_ns_ = 0;
+  last_tick_wall_ns_ = wall_clock_.nsecsElapsed();
+  QAnimationDriver::start();
+  // The fallback timer only runs while there are animations to keep the event loop idle otherwise
+  restartFallbackTimer( FallbackDelayMs );
+}
+
+void FrameAnimationDriver::stop()
+{
+  fallback_timer_.stop();
+  QAnimationDriver::stop();
+}
+
+void FrameAnimationDriver::advanceBy( qint64 ns )
+{
+  if ( driver_paused )
+    return;
+  // Accumulated in ns since rounding each frame's step to ms would slow down animations noticeably
+  const qint64 now = wall_clock_.nsecsElapsed();
+  // The fallback may already have advanced part of the time since the last frame
+  ns = std::min( ns, now - last_tick_wall_ns_ );
+  if ( driver_mode == FrameSyncedPausing )
+    ns = std::min( ns, MaxPausingStepNs );
+  elapsed_ns_ += std::max<qint64>( ns, 0 );
+  last_tick_wall_ns_ = now;
+  tick( now );
+  restartFallbackTimer( FallbackDelayMs );
+}
+
+void FrameAnimationDriver::restartFallbackTimer( int ms )
+{
+  if ( driver_mode != FrameSynced || !isRunning() )
+    return;
+  fallback_timer_.start( ms );
+}
+
+void FrameAnimationDriver::onFallbackTimeout()
+{
+  // Only reached if no frame was rendered for FallbackDelayMs since frames restart the timer
+  if ( driver_paused )
+    return;
+  const qint64 now = wall_clock_.nsecsElapsed();
+  elapsed_ns_ += now - last_tick_wall_ns_;
+  last_tick_wall_ns_ = now;
+  tick( now );
+  restartFallbackTimer( FallbackIntervalMs );
+}
+
+void FrameAnimationDriver::tick( qint64 now )
+{
+  if ( !isRunning() )
+    return;
+  if ( driver_max_tick_rate > 0 && now - last_advance_wall_ns_ < 1E9 / driver_max_tick_rate )
+    return;
+  last_advance_wall_ns_ = now;
+  advance();
+}
+} // namespace hector_rviz_overlay
@@ -17,11 +17,14 @@
 
 #include "hector_rviz_overlay/render/overlay_renderer.hpp"
 
+#include "hector_rviz_overlay/render/frame_animation_driver.hpp"
 #include "hector_rviz_overlay/render/qimage_texture_overlay_renderer.hpp"
 #include "hector_rviz_overlay/render/qopengl_texture_overlay_renderer.hpp"
 
+#include <algorithm>
 #include <chrono>
 
+#include <QGuiApplication>
 #include <QPainter>
 
 #include <rviz_common/display_context.hpp>
@@ -30,6 +33,24 @@
 
 namespace hector_rviz_overlay
 {
+namespace
+{
+// Give rviz time to load the config and settle before hidden overlays are warmed up
+constexpr std::chrono::milliseconds WarmUpDelay( 2000 );
+// Spreads the warm-ups of multiple overlays to avoid consecutive slow frames
+constexpr std::chrono::milliseconds WarmUpInterval( 250 );
+// Lets the average render time settle after the resolution changed
+constexpr std::chrono::milliseconds ResolutionUpdateInterval( 1000 );
+// Coarse steps keep the number of distinct layer sizes and thereby re-renders low
+constexpr float ResolutionStep = 0.125f;
+// Deferred overlays gain one priority level per interval waited so that they can't be starved
+constexpr double PriorityAgingIntervalMs = 100;
+
+double toMilliseconds( std::chrono::high_resolution_clock::duration duration )
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>( duration ).count() / 1000.0;
+}
+} // namespace
 
 OverlayRenderer *OverlayRenderer::create( rviz_common::DisplayContext *context )
 {
@@ -42,9 +63,16 @@ OverlayRenderer *OverlayRenderer::create( rviz_common::DisplayContext *context )
 }
 
 OverlayRenderer::OverlayRenderer( rviz_common::DisplayContext *context )
-    : context_( context ), timer_index_( 0 ), no_visible_overlays_( true )
+    : OverlayRenderer( static_cast<QWidget *>( context->getViewManager()->getRenderPanel() ) )
 {
-  render_panel_ = context_->getViewManager()->getRenderPanel();
+  context_ = context;
+}
+
+OverlayRenderer::OverlayRenderer( QWidget *render_panel )
+    : context_( nullptr ), render_panel_( render_panel ), timer_index_( 0 ),
+      no_visible_overlays_( true )
+{
+  next_warm_up_ = std::chrono::high_resolution_clock::now() + WarmUpDelay;
   std::fill( timer_history_, timer_history_ + TimerHistoryLength, 0.0 );
   timer_average_ = 0;
 }
@@ -87,8 +115,15 @@ void OverlayRenderer::removeOverlay( OverlayPtr &overlay )
               &OverlayRenderer::onVisibilityChanged );
   overlays_.erase( std::remove( overlays_.begin(), overlays_.end(), overlay ), overlays_.end() );
 
-  if ( initialized_ )
-    releaseOverlay( overlay );
+  auto state_it = overlay_states_.find( overlay.get() );
+  bool released = state_it != overlay_states_.end() && state_it->second.released;
+  if ( initialized_ ) {
+    releaseOverlayLayer( *overlay );
+    if ( !released )
+      releaseOverlay( overlay );
+  }
+  if ( state_it != overlay_states_.end() )
+    overlay_states_.erase( state_it );
 
   if ( !no_visible_overlays_ && overlay->isVisible() ) {
     bool last_visible = true;
@@ -108,8 +143,16 @@ void OverlayRenderer::removeOverlay( OverlayPtr &overlay )
   is_dirty_ = true;
 }
 
+void OverlayRenderer::reorderOverlays( const std::vector<OverlayPtr> &order )
+{
+  overlays_ = order;
+  is_dirty_ = true;
+}
+
 void OverlayRenderer::onVisibilityChanged()
 {
+  // The composition has to be updated even if no overlay is dirty
+  is_dirty_ = true;
   auto sender = static_cast<Overlay *>( QObject::sender() );
   if ( sender->isVisible() ) {
     // If the overlay is visible make sure it is drawn
@@ -141,14 +184,134 @@ std::vector<OverlayConstPtr> OverlayRenderer::overlays() const
   return std::vector<OverlayConstPtr>( overlays_.begin(), overlays_.end() );
 }
 
+double OverlayRenderer::frameTimeBudget() const { return frame_time_budget_ms_; }
+
+void OverlayRenderer::setFrameTimeBudget( double value )
+{
+  frame_time_budget_ms_ = std::max( 0.0, value );
+}
+
+OverlayRenderStats OverlayRenderer::renderStats( const Overlay *overlay ) const
+{
+  auto it = overlay_states_.find( overlay );
+  if ( it == overlay_states_.end() )
+    return {};
+  return it->second.stats;
+}
+
+void OverlayRenderer::resetRenderStats()
+{
+  for ( auto &entry : overlay_states_ ) entry.second.stats = {};
+}
+
+float OverlayRenderer::globalMaxUpdateRate() const { return global_max_update_rate_; }
+
+void OverlayRenderer::setGlobalMaxUpdateRate( float value )
+{
+  global_max_update_rate_ = value < 0 ? 0 : value;
+}
+
+bool OverlayRenderer::isSuspended() const { return suspended_; }
+
+void OverlayRenderer::setSuspended( bool value )
+{
+  if ( suspended_ == value )
+    return;
+  suspended_ = value;
+  if ( suspended_ )
+    return;
+  // Don't pass the time spent suspended to the overlays and redraw immediately when resumed
+  last_update_ = std::chrono::high_resolution_clock::time_point::max();
+  is_dirty_ = true;
+}
+
+bool OverlayRenderer::warmUpEnabled() const { return warm_up_enabled_; }
+
+void OverlayRenderer::setWarmUpEnabled( bool value ) { warm_up_enabled_ = value; }
+
+float OverlayRenderer::renderResolution() const { return render_resolution_; }
+
+void OverlayRenderer::setRenderResolution( float value )
+{
+  render_resolution_ = std::clamp( value, MinRenderResolution, 1.0f );
+  if ( !adaptive_render_resolution_ ) {
+    effective_render_resolution_ = render_resolution_;
+    return;
+  }
+  effective_render_resolution_ = std::clamp( effective_render_resolution_,
+                                             std::min( min_adaptive_render_resolution_,
+                                                       render_resolution_ ),
+                                             render_resolution_ );
+}
+
+bool OverlayRenderer::adaptiveRenderResolution() const { return adaptive_render_resolution_; }
+
+void OverlayRenderer::setAdaptiveRenderResolution( bool value )
+{
+  adaptive_render_resolution_ = value;
+  effective_render_resolution_ = render_resolution_;
+  average_render_time_ms_ = 0;
+  has_render_time_sample_ = false;
+}
+
+float OverlayRenderer::minAdaptiveRenderResolution() const
+{
+  return min_adaptive_render_resolution_;
+}
+
+void OverlayRenderer::setMinAdaptiveRenderResolution( float value )
+{
+  min_adaptive_render_resolution_ = std::clamp( value, MinRenderResolution, 1.0f );
+  // Clamps the effective render resolution to the new range
+  setRenderResolution( render_resolution_ );
+}
+
+double OverlayRenderer::targetRenderTime() const { return target_render_time_ms_; }
+
+void OverlayRenderer::setTargetRenderTime( double value )
+{
+  target_render_time_ms_ = std::max( 0.0, value );
+}
+
+float OverlayRenderer::effectiveRenderResolution() const { return effective_render_resolution_; }
+
+float OverlayRenderer::resolutionScale() const noexcept { return layer_resolution_; }
+
+float OverlayRenderer::layerResolution( const Overlay &overlay ) const
+{
+  return overlay.supportsResolutionScale() ? effective_render_resolution_ : 1.0f;
+}
+
 void OverlayRenderer::prepareOverlay( OverlayPtr &overlay ) { overlay->prepareRender( this ); }
 
 void OverlayRenderer::releaseOverlay( OverlayPtr &overlay ) { overlay->releaseRenderResources(); }
 
+void OverlayRenderer::releaseOverlays()
+{
+  if ( !initialized_ )
+    return;
+  for ( auto &overlay : overlays_ ) {
+    auto state_it = overlay_states_.find( overlay.get() );
+    if ( state_it != overlay_states_.end() && state_it->second.released )
+      continue;
+    releaseOverlay( overlay );
+  }
+  overlay_states_.clear();
+  initialized_ = false;
+}
+
 void OverlayRenderer::render()
 {
-  if ( no_visible_overlays_ )
+  // Apply updates from other threads even if nothing is visible to keep the queues from filling up
+  for ( const auto &overlay : overlays_ ) { overlay->processQueuedUpdates(); }
+  if ( initialized_ && !suspended_ )
+    updateHiddenOverlays( std::chrono::high_resolution_clock::now() );
+  if ( suspended_ )
     return;
+  if ( no_visible_overlays_ ) {
+    warmUpHiddenOverlay();
+    return;
+  }
   if ( !initialized_ ) {
     initialize();
     initialized_ = true;
@@ -161,7 +324,12 @@ void OverlayRenderer::render()
   if ( delta < 0 )
     delta = 0;
   last_update_ = start;
-  for ( const auto &overlay : overlays_ ) { overlay->update( delta ); }
+  // Animations are advanced exactly once per frame before the overlays are updated and rendered
+  FrameAnimationDriver::advanceFrame( delta );
+  for ( const auto &overlay : overlays_ ) {
+    if ( overlay->isVisible() || overlay->hiddenPolicy() == Overlay::KeepWarm )
+      overlay->update( delta );
+  }
 
   bool is_dirty = is_dirty_;
   is_dirty_ = false;
@@ -173,38 +341,53 @@ void OverlayRenderer::render()
   if ( geometry_.size() != render_panel_->geometry().size() ) {
     geometry_ = render_panel_->geometry();
     is_dirty = true;
+    // The layers have the wrong size now, hence, all overlays have to be rendered again
+    for ( auto &entry : overlay_states_ ) entry.second.has_layer = false;
   }
 
   const QPoint &render_panel_top_left = render_panel_->mapToGlobal( QPoint( 0, 0 ) );
   if ( geometry_.topLeft() != render_panel_top_left ) {
     geometry_.moveTopLeft( render_panel_top_left );
     is_dirty = true;
-  } else {
-    for ( const auto &overlay : overlays_ ) {
-      if ( !overlay->isDirty() )
-        continue;
-      is_dirty = true;
-      break;
+  }
+  for ( const auto &overlay : overlays_ ) {
+    if ( !overlay->isVisible() )
+      continue;
+    if ( overlay->geometry().topLeft() != geometry_.topLeft() ||
+         overlay->geometry().size() != geometry_.size() ) {
+      overlay->setGeometry( geometry_ );
     }
   }
-  if ( !is_dirty ) {
+  scheduleOverlays( start );
+  // Overlays that are dirty but limited by their update rate keep their layer, hence, nothing to do
+  if ( !is_dirty && render_queue_.empty() ) {
+    restoreIdleRenderResolution( start );
     redrawLastFrame();
+    // Nothing else to do in this frame, hence, a good time to warm up a hidden overlay
+    warmUpHiddenOverlay();
     return;
   }
 
   prepareRender( width, height );
-  // Draw the overlays
-  for ( size_t i = 0; i < overlays_.size(); ++i ) {
-    OverlayPtr overlay = overlays_[i];
+  auto render_start = std::chrono::high_resolution_clock::now();
+  if ( renderScheduledOverlays( start ) ) {
+    updateRenderResolution(
+        start, toMilliseconds( std::chrono::high_resolution_clock::now() - render_start ) );
+  } else {
+    restoreIdleRenderResolution( start );
+  }
+
+  // Compose the layers of all visible overlays in order
+  beginComposition();
+  for ( const auto &overlay : overlays_ ) {
     if ( !overlay->isVisible() )
       continue;
-    if ( overlay->geometry().topLeft() != geometry_.topLeft() ||
-         overlay->geometry().size() != geometry_.size() ) {
-      overlays_[i]->setGeometry( geometry_ );
-    }
-
-    overlays_[i]->render( this );
+    auto it = overlay_states_.find( overlay.get() );
+    if ( it == overlay_states_.end() || !it->second.has_layer )
+      continue;
+    composeOverlay( *overlay );
   }
+  endComposition();
 
 #ifdef DRAW_RENDERTIME
   QPainter painter( paintDevice() );
@@ -225,5 +408,209 @@ void OverlayRenderer::render()
   timer_index_ = ( timer_index_ + 1 ) % TimerHistoryLength;
 }
 
+void OverlayRenderer::scheduleOverlays( const std::chrono::high_resolution_clock::time_point &now )
+{
+  render_queue_.clear();
+  for ( const auto &overlay : overlays_ ) {
+    if ( !overlay->isVisible() )
+      continue;
+    OverlayState &state = overlay_states_[overlay.get()];
+    // Layers at an outdated resolution are still composed (scaled) until they are rendered again
+    if ( !overlay->isDirty() && state.has_layer && state.resolution == layerResolution( *overlay ) )
+      continue;
+    if ( !state.pending ) {
+      state.pending = true;
+      state.pending_since = now;
+    }
+    // Coalesce render requests until the next slot if the overlay is limited by its update rate
+    float max_update_rate = overlay->maxUpdateRate();
+    if ( global_max_update_rate_ > 0 &&
+         ( max_update_rate == 0 || global_max_update_rate_ < max_update_rate ) )
+      max_update_rate = global_max_update_rate_;
+    if ( state.has_layer && max_update_rate > 0 &&
+         toMilliseconds( now - state.last_render ) < 1000.0 / max_update_rate )
+      continue;
+    state.effective_priority =
+        overlay->renderPriority() +
+        static_cast<int>( toMilliseconds( now - state.pending_since ) / PriorityAgingIntervalMs );
+    render_queue_.push_back( overlay.get() );
+  }
+
+  // Overlays without a layer first since there is nothing we could show instead, then by priority
+  // aged by the time spent waiting and finally the ones that have been waiting the longest.
+  std::sort( render_queue_.begin(), render_queue_.end(), [this]( Overlay *a, Overlay *b ) {
+    const OverlayState &state_a = overlay_states_[a];
+    const OverlayState &state_b = overlay_states_[b];
+    if ( state_a.has_layer != state_b.has_layer )
+      return !state_a.has_layer;
+    if ( state_a.effective_priority != state_b.effective_priority )
+      return state_a.effective_priority > state_b.effective_priority;
+    return state_a.pending_since < state_b.pending_since;
+  } );
+}
+
+void OverlayRenderer::updateHiddenOverlays( const std::chrono::high_resolution_clock::time_point &now )
+{
+  for ( auto &overlay : overlays_ ) {
+    OverlayState &state = overlay_states_[overlay.get()];
+    if ( overlay->isVisible() ) {
+      state.hidden = false;
+      if ( state.released ) {
+        prepareOverlay( overlay );
+        state.released = false;
+      }
+      continue;
+    }
+    if ( !state.hidden ) {
+      state.hidden = true;
+      state.hidden_since = now;
+    }
+    if ( state.released || overlay->hiddenPolicy() != Overlay::ReleaseWhenHidden )
+      continue;
+    if ( toMilliseconds( now - state.hidden_since ) < overlay->releaseDelay() * 1000.0 )
+      continue;
+    releaseOverlayLayer( *overlay );
+    releaseOverlay( overlay );
+    state.has_layer = false;
+    state.pending = false;
+    state.released = true;
+  }
+}
+
+bool OverlayRenderer::renderScheduledOverlays(
+    const std::chrono::high_resolution_clock::time_point &frame_start )
+{
+  using clock = std::chrono::high_resolution_clock;
+  bool rendered_any = false;
+  for ( Overlay *overlay : render_queue_ ) {
+    OverlayState &state = overlay_states_[overlay];
+    if ( frame_time_budget_ms_ > 0 && rendered_any && state.has_layer ) {
+      double elapsed_ms = toMilliseconds( clock::now() - frame_start );
+      if ( elapsed_ms + state.stats.average_render_time_ms > frame_time_budget_ms_ ) {
+        // Keep showing the last content and try again next frame
+        ++state.stats.deferrals;
+        continue;
+      }
+    }
+
+    clock::time_point render_start = clock::now();
+    layer_resolution_ = layerResolution( *overlay );
+    beginOverlayRender( *overlay );
+    overlay->render( this );
+    endOverlayRender( *overlay );
+    state.resolution = layer_resolution_;
+    layer_resolution_ = 1;
+    clock::time_point render_end = clock::now();
+
+    OverlayRenderStats &stats = state.stats;
+    double render_time_ms = toMilliseconds( render_end - render_start );
+    stats.average_render_time_ms = stats.renders == 0 ? render_time_ms
+                                                      : 0.8 * stats.average_render_time_ms +
+                                                            0.2 * render_time_ms;
+    ++stats.renders;
+    stats.last_latency_ms = toMilliseconds( render_end - state.pending_since );
+    stats.worst_latency_ms = std::max( stats.worst_latency_ms, stats.last_latency_ms );
+    state.last_render = render_start;
+    state.pending = false;
+    state.has_layer = true;
+    state.rendered = true;
+    rendered_any = true;
+  }
+  return rendered_any;
+}
+
+void OverlayRenderer::updateRenderResolution(
+    const std::chrono::high_resolution_clock::time_point &now, double render_time_ms )
+{
+  if ( !adaptive_render_resolution_ )
+    return;
+  average_render_time_ms_ = has_render_time_sample_
+                                ? 0.9 * average_render_time_ms_ + 0.1 * render_time_ms
+                                : render_time_ms;
+  has_render_time_sample_ = true;
+  last_render_time_sample_ = now;
+  if ( now < next_resolution_update_ )
+    return;
+  float resolution = effective_render_resolution_;
+  if ( average_render_time_ms_ > target_render_time_ms_ )
+    resolution -= ResolutionStep;
+  // The render time scales with the number of pixels, hence, a step up from below half of the
+  // target stays below the target (for resolutions above 0.25) instead of oscillating
+  else if ( average_render_time_ms_ < 0.5 * target_render_time_ms_ )
+    resolution += ResolutionStep;
+  resolution = std::clamp( resolution,
+                           std::min( min_adaptive_render_resolution_, render_resolution_ ),
+                           render_resolution_ );
+  if ( resolution == effective_render_resolution_ )
+    return;
+  effective_render_resolution_ = resolution;
+  next_resolution_update_ = now + ResolutionUpdateInterval;
+}
+
+void OverlayRenderer::restoreIdleRenderResolution(
+    const std::chrono::high_resolution_clock::time_point &now )
+{
+  if ( !adaptive_render_resolution_ || effective_render_resolution_ == render_resolution_ ||
+       now - last_render_time_sample_ < ResolutionUpdateInterval )
+    return;
+  // The layers would otherwise keep the reduced resolution until the overlays change. Once they
+  // change, they are measured anew at the full resolution.
+  effective_render_resolution_ = render_resolution_;
+  has_render_time_sample_ = false;
+  next_resolution_update_ = now + ResolutionUpdateInterval;
+}
+
 QWindow *OverlayRenderer::window() { return render_panel_->windowHandle(); }
+
+void OverlayRenderer::warmUpHiddenOverlay()
+{
+  using clock = std::chrono::high_resolution_clock;
+  if ( !warm_up_enabled_ )
+    return;
+  clock::time_point now = clock::now();
+  if ( now < next_warm_up_ )
+    return;
+  // The user is probably interacting with the 3D view
+  if ( QGuiApplication::mouseButtons() != Qt::NoButton )
+    return;
+
+  OverlayPtr candidate;
+  for ( const auto &overlay : overlays_ ) {
+    if ( overlay->isVisible() || overlay->hiddenPolicy() == Overlay::ReleaseWhenHidden )
+      continue;
+    const OverlayState &state = overlay_states_[overlay.get()];
+    if ( state.rendered || state.released )
+      continue;
+    candidate = overlay;
+    break;
+  }
+  if ( candidate == nullptr )
+    return;
+
+  if ( !initialized_ ) {
+    initialize();
+    initialized_ = true;
+    for ( auto &overlay : overlays_ ) prepareOverlay( overlay );
+  }
+  QRect geometry = render_panel_->geometry();
+  geometry.moveTopLeft( render_panel_->mapToGlobal( QPoint( 0, 0 ) ) );
+  if ( candidate->geometry() != geometry )
+    candidate->setGeometry( geometry );
+
+  prepareRender( geometry.width(), geometry.height() );
+  layer_resolution_ = layerResolution( *candidate );
+  beginOverlayRender( *candidate );
+  candidate->render( this );
+  endOverlayRender( *candidate );
+  finishOffscreenRender();
+
+  OverlayState &state = overlay_states_[candidate.get()];
+  state.resolution = layer_resolution_;
+  layer_resolution_ = 1;
+  state.rendered = true;
+  // The layer is only valid as long as the size does not change
+  state.has_layer = geometry.size() == geometry_.size();
+  state.last_render = now;
+  next_warm_up_ = clock::now() + WarmUpInterval;
+}
 } // namespace hector_rviz_overlay
@@ -17,11 +17,43 @@
 
 #include "hector_rviz_overlay/render/qimage_texture_overlay_renderer.hpp"
 
+#include <QPainter>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include <OgreHardwarePixelBuffer.h>
 #include <OgreTexture.h>
 
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
 namespace hector_rviz_overlay
 {
 
+namespace
+{
+bool isEqual( const unsigned char *a, const unsigned char *b, size_t bytes )
+{
+#ifdef __SSE2__
+  __m128i difference = _mm_setzero_si128();
+  size_t i = 0;
+  for ( ; i + 16 <= bytes; i += 16 ) {
+    __m128i value_a = _mm_loadu_si128( reinterpret_cast<const __m128i *>( a + i ) );
+    __m128i value_b = _mm_loadu_si128( reinterpret_cast<const __m128i *>( b + i ) );
+    difference = _mm_or_si128( difference, _mm_xor_si128( value_a, value_b ) );
+  }
+  if ( _mm_movemask_epi8( _mm_cmpeq_epi8( difference, _mm_setzero_si128() ) ) != 0xFFFF )
+    return false;
+  return std::memcmp( a + i, b + i, bytes - i ) == 0;
+#else
+  return std::memcmp( a, b, bytes ) == 0;
+#endif
+}
+} // namespace
+
 QImageTextureOverlayRenderer::QImageTextureOverlayRenderer( rviz_common::DisplayContext *context )
     : TextureOverlayRenderer( context )
 {
@@ -29,35 +61,224 @@ QImageTextureOverlayRenderer::QImageTextureOverlayRenderer( rviz_common::Display
 
 void QImageTextureOverlayRenderer::initialize() { /* Nothing to do */ }
 
-void QImageTextureOverlayRenderer::releaseResources() { /* Nothing to do */ }
+void QImageTextureOverlayRenderer::releaseResources()
+{
+  layers_.clear();
+  last_composed_overlays_.clear();
+  std::fill( dirty_tiles_.begin(), dirty_tiles_.end(), 1 );
+}
 
 void QImageTextureOverlayRenderer::prepareRender( int width, int height )
 {
   TextureOverlayRenderer::prepareRender( width, height );
-  buffer_ = texture_->getBuffer();
-  buffer_->lock( Ogre::HardwareBuffer::HBL_DISCARD );
-  const Ogre::PixelBox &pixel_box = buffer_->getCurrentLock();
-
-  auto data = static_cast<Ogre::uint8 *>( pixel_box.data );
-  int bytes_per_line = pixel_box.getWidth() * 4;
-  // Empties the texture by overwriting all ARGB data with 0.
-  Ogre::uint8 *offset = data;
-  for ( int i = 0; i < height; ++i ) {
-    memset( offset, 0, width * 4 );
-    offset += bytes_per_line;
+  if ( width != width_ || height != height_ ) {
+    width_ = width;
+    height_ = height;
+    paint_device_image_ = QImage( width_, height_, QImage::Format_ARGB32_Premultiplied );
+    paint_device_image_.fill( Qt::transparent );
+    current_paint_device_ = &paint_device_image_;
+    composition_columns_ = ( width_ + TileSize - 1 ) / TileSize;
+    composition_rows_ = ( height_ + TileSize - 1 ) / TileSize;
+    // Everything is composed and uploaded anew
+    dirty_tiles_.assign( composition_columns_ * composition_rows_, 1 );
+    upload_tiles_.assign( composition_columns_ * composition_rows_, 0 );
+    last_composed_overlays_.clear();
+    upload_all_ = true;
+  }
+  if ( texture_.get() != uploaded_texture_ )
+    upload_all_ = true;
+}
+
+void QImageTextureOverlayRenderer::beginOverlayRender( const Overlay &overlay )
+{
+  QImage &image = layers_[&overlay].image;
+  int width = std::max( 1, (int)std::lround( width_ * resolutionScale() ) );
+  int height = std::max( 1, (int)std::lround( height_ * resolutionScale() ) );
+  if ( image.width() != width || image.height() != height )
+    image = QImage( width, height, QImage::Format_ARGB32_Premultiplied );
+  image.fill( Qt::transparent );
+  current_paint_device_ = &image;
+}
+
+void QImageTextureOverlayRenderer::endOverlayRender( const Overlay &overlay )
+{
+  current_paint_device_ = &paint_device_image_;
+  Layer &layer = layers_[&overlay];
+  // The content may have changed where the layer was visible before and where it is visible now
+  markDirty( layer );
+  if ( layer.image.width() == width_ && layer.image.height() == height_ ) {
+    computeTileOccupancy( layer.image.constBits(), width_, height_, layer.image.bytesPerLine(),
+                          false, layer.tiles );
+  } else {
+    // Layers with a reduced resolution are scaled, hence, they are assumed to cover every tile
+    layer.tiles.assign( dirty_tiles_.size(), 1 );
+  }
+  markDirty( layer );
+}
+
+void QImageTextureOverlayRenderer::markDirty( const Layer &layer )
+{
+  if ( layer.tiles.size() != dirty_tiles_.size() ) {
+    // The layer was rendered for a different size
+    std::fill( dirty_tiles_.begin(), dirty_tiles_.end(), 1 );
+    return;
+  }
+  for ( size_t i = 0; i < dirty_tiles_.size(); ++i ) dirty_tiles_[i] |= layer.tiles[i];
+}
+
+void QImageTextureOverlayRenderer::beginComposition() { composed_overlays_.clear(); }
+
+void QImageTextureOverlayRenderer::composeOverlay( const Overlay &overlay )
+{
+  // Composed in endComposition once it is known which tiles are dirty
+  if ( layers_.find( &overlay ) != layers_.end() )
+    composed_overlays_.push_back( &overlay );
+}
+
+void QImageTextureOverlayRenderer::endComposition()
+{
+  if ( composed_overlays_ != last_composed_overlays_ ) {
+    // Overlays were shown, hidden or reordered which may change every tile covered by them
+    for ( const Overlay *overlay : composed_overlays_ ) markDirty( layers_[overlay] );
+    for ( const Overlay *overlay : last_composed_overlays_ ) {
+      auto it = layers_.find( overlay );
+      if ( it != layers_.end() )
+        markDirty( it->second );
+    }
+    last_composed_overlays_ = composed_overlays_;
+  }
+  for ( int row = 0; row < composition_rows_; ++row ) {
+    const unsigned char *dirty = dirty_tiles_.data() + row * composition_columns_;
+    if ( std::find( dirty, dirty + composition_columns_, 1 ) != dirty + composition_columns_ )
+      composeTileRow( row );
+  }
+  std::fill( dirty_tiles_.begin(), dirty_tiles_.end(), 0 );
+}
+
+void QImageTextureOverlayRenderer::composeTileRow( int row )
+{
+  const int top = row * TileSize;
+  const int height = std::min( TileSize, height_ - top );
+  if ( tile_row_image_.width() != width_ || tile_row_image_.height() != TileSize )
+    tile_row_image_ = QImage( width_, TileSize, QImage::Format_ARGB32_Premultiplied );
+  const unsigned char *dirty = dirty_tiles_.data() + row * composition_columns_;
+  QRegion region;
+  for ( int column = 0; column < composition_columns_; ++column ) {
+    if ( !dirty[column] )
+      continue;
+    const int left = column * TileSize;
+    region += QRect( left, 0, std::min( TileSize, width_ - left ), height );
+  }
+  {
+    QPainter painter( &tile_row_image_ );
+    painter.setClipRegion( region );
+    painter.setCompositionMode( QPainter::CompositionMode_Source );
+    painter.fillRect( region.boundingRect(), Qt::transparent );
+    painter.setCompositionMode( QPainter::CompositionMode_SourceOver );
+    painter.setRenderHint( QPainter::SmoothPixmapTransform );
+    painter.translate( 0, -top );
+    for ( const Overlay *overlay : composed_overlays_ ) {
+      const QImage &image = layers_[overlay].image;
+      if ( image.width() == width_ && image.height() == height_ )
+        painter.drawImage( 0, 0, image );
+      else // The layer was rendered at a reduced resolution
+        painter.drawImage( QRect( 0, 0, width_, height_ ), image );
+    }
+  }
+
+  // Only tiles whose content changed are copied into the composition and uploaded
+  for ( int column = 0; column < composition_columns_; ++column ) {
+    if ( !dirty[column] )
+      continue;
+    const int offset = column * TileSize * 4;
+    const int bytes = std::min( TileSize, width_ - column * TileSize ) * 4;
+    bool changed = false;
+    for ( int y = 0; y < height && !changed; ++y ) {
+      changed = !isEqual( tile_row_image_.constScanLine( y ) + offset,
+                          paint_device_image_.constScanLine( top + y ) + offset, bytes );
+    }
+    if ( !changed )
+      continue;
+    for ( int y = 0; y < height; ++y ) {
+      std::memcpy( paint_device_image_.scanLine( top + y ) + offset,
+                   tile_row_image_.constScanLine( y ) + offset, bytes );
+    }
+    upload_tiles_[row * composition_columns_ + column] = 1;
+  }
+}
+
+void QImageTextureOverlayRenderer::releaseOverlayLayer( const Overlay &overlay )
+{
+  auto it = layers_.find( &overlay );
+  if ( it == layers_.end() )
+    return;
+  markDirty( it->second );
+  layers_.erase( it );
+}
+
+bool QImageTextureOverlayRenderer::uploadTiles()
+{
+  if ( !texture_ || paint_device_image_.isNull() )
+    return false;
+  Ogre::HardwarePixelBufferSharedPtr buffer = texture_->getBuffer();
+  unsigned char *bits = paint_device_image_.bits();
+  const int bytes_per_line = paint_device_image_.bytesPerLine();
+  auto upload = [&]( int left, int top, int right, int bottom ) {
+    // The data points to the top left of the region, so the box does not need an offset
+    Ogre::PixelBox source( right - left, bottom - top, 1, Ogre::PF_A8R8G8B8,
+                           bits + static_cast<size_t>( top ) * bytes_per_line + left * 4 );
+    source.rowPitch = bytes_per_line / 4;
+    source.slicePitch = source.rowPitch * ( bottom - top );
+    buffer->blitFromMemory( source, Ogre::Box( left, top, right, bottom ) );
+  };
+
+  if ( upload_all_ ) {
+    upload( 0, 0, width_, height_ );
+    upload_all_ = false;
+    uploaded_texture_ = texture_.get();
+    std::fill( upload_tiles_.begin(), upload_tiles_.end(), 0 );
+    return true;
   }
-  paint_device_image_ =
-      QImage( data, width, height, bytes_per_line, QImage::Format_ARGB32_Premultiplied );
+  bool uploaded = false;
+  for ( int row = 0; row < composition_rows_; ++row ) {
+    const unsigned char *tiles = upload_tiles_.data() + row * composition_columns_;
+    const int top = row * TileSize;
+    const int bottom = std::min( top + TileSize, height_ );
+    for ( int column = 0; column < composition_columns_; ) {
+      if ( !tiles[column] ) {
+        ++column;
+        continue;
+      }
+      // Adjacent tiles are uploaded at once
+      int end = column + 1;
+      while ( end < composition_columns_ && tiles[end] ) ++end;
+      upload( column * TileSize, top, std::min( end * TileSize, width_ ), bottom );
+      uploaded = true;
+      column = end;
+    }
+  }
+  std::fill( upload_tiles_.begin(), upload_tiles_.end(), 0 );
+  return uploaded;
 }
 
 void QImageTextureOverlayRenderer::finishRender()
 {
-  buffer_->unlock();
-  buffer_.reset();
+#ifdef DRAW_RENDERTIME
+  // The render time is drawn on top of the composition, hence, everything is uploaded and the
+  // tiles are composed anew in the next frame
+  upload_all_ = true;
+  std::fill( dirty_tiles_.begin(), dirty_tiles_.end(), 1 );
+#endif
+  // The visible tiles can only change if the content of a tile changed
+  if ( uploadTiles() )
+    updateTiles( paint_device_image_.constBits(), paint_device_image_.bytesPerLine(), false );
   TextureOverlayRenderer::finishRender();
 }
 
-QPaintDevice *QImageTextureOverlayRenderer::paintDevice() noexcept { return &paint_device_image_; }
+QPaintDevice *QImageTextureOverlayRenderer::paintDevice() noexcept
+{
+  return current_paint_device_;
+}
 
 QOpenGLFramebufferObject *QImageTextureOverlayRenderer::framebufferObject()
 {
@@ -6,9 +6,14 @@
 
 #include "qopengl_wrapper.hpp"
 
+#include <QOpenGLFramebufferObject>
+
 #include <rviz_common/display_context.hpp>
 #include <rviz_rendering/render_system.hpp>
 
+#include <algorithm>
+#include <cmath>
+
 namespace hector_rviz_overlay
 {
 QOpenGLTextureOverlayRenderer::QOpenGLTextureOverlayRenderer( rviz_common::DisplayContext *context )
@@ -53,6 +58,39 @@ void QOpenGLTextureOverlayRenderer::prepareRender( int width, int height )
   qopengl_wrapper_->prepareRender();
 }
 
+void QOpenGLTextureOverlayRenderer::beginOverlayRender( const Overlay & )
+{
+  const QSize &size = qopengl_wrapper_->size();
+  qopengl_wrapper_->beginLayer(
+      QSize( std::max( 1, (int)std::lround( size.width() * resolutionScale() ) ),
+             std::max( 1, (int)std::lround( size.height() * resolutionScale() ) ) ) );
+}
+
+void QOpenGLTextureOverlayRenderer::endOverlayRender( const Overlay &overlay )
+{
+  qopengl_wrapper_->endLayer( layers_[&overlay] );
+}
+
+void QOpenGLTextureOverlayRenderer::beginComposition() { qopengl_wrapper_->beginComposition(); }
+
+void QOpenGLTextureOverlayRenderer::composeOverlay( const Overlay &overlay )
+{
+  auto it = layers_.find( &overlay );
+  if ( it == layers_.end() || it->second == nullptr )
+    return;
+  qopengl_wrapper_->composeLayer( *it->second );
+}
+
+void QOpenGLTextureOverlayRenderer::releaseOverlayLayer( const Overlay &overlay )
+{
+  auto it = layers_.find( &overlay );
+  if ( it == layers_.end() || qopengl_wrapper_ == nullptr )
+    return;
+  qopengl_wrapper_->makeCurrent();
+  layers_.erase( it );
+  qopengl_wrapper_->doneCurrent();
+}
+
 void QOpenGLTextureOverlayRenderer::finishRender()
 {
   framebuffer_object_updated_ = false;
@@ -63,17 +101,22 @@ void QOpenGLTextureOverlayRenderer::finishRender()
   glBindTexture( GL_TEXTURE_2D, texture_id_ );
   glTexImage2D( GL_TEXTURE_2D, 0, GL_RGBA8, qopengl_wrapper_->size().width(),
                 qopengl_wrapper_->size().height(), 0, GL_RGBA, GL_UNSIGNED_BYTE, pixel_data_.data() );
+  // The framebuffer's texture has its origin at the bottom left
+  updateTiles( pixel_data_.data(), qopengl_wrapper_->size().width() * 4, true );
   TextureOverlayRenderer::finishRender();
 }
 
+void QOpenGLTextureOverlayRenderer::finishOffscreenRender() { qopengl_wrapper_->doneCurrent(); }
+
 void QOpenGLTextureOverlayRenderer::releaseResources()
 {
   if ( qopengl_wrapper_ == nullptr )
     return;
 
-  qopengl_wrapper_->makeCurrent();
-  for ( auto &overlay : overlays_ ) { overlay->releaseRenderResources(); }
+  releaseOverlays();
   overlays_.clear();
+  qopengl_wrapper_->makeCurrent();
+  layers_.clear();
   qopengl_wrapper_->doneCurrent();
   qopengl_wrapper_.reset();
 }
@@ -23,6 +23,7 @@
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions>
 #include <QOpenGLPaintDevice>
+#include <QOpenGLTextureBlitter>
 #include <QPainter>
 
 #include <GL/glx.h>
@@ -39,7 +40,7 @@ struct QOpenGLWrapper::NativeContextInformation {
 QOpenGLWrapper::QOpenGLWrapper( QOpenGLContext *native_context, const QSize &size, int gl_version )
     : size_( size ), native_opengl_context_( native_context ), opengl_context_( nullptr ),
       surface_( nullptr ), fbo_( nullptr ), texture_fbo_( nullptr ), paint_device_( nullptr ),
-      opengl_context_is_current_( false ), native_context_information_( nullptr )
+      blitter_( nullptr ), opengl_context_is_current_( false ), native_context_information_( nullptr )
 {
   native_context_information_ = new NativeContextInformation;
 
@@ -66,6 +67,10 @@ QOpenGLWrapper::QOpenGLWrapper( QOpenGLContext *native_context, const QSize &siz
 
   makeCurrent();
 
+  blitter_ = new QOpenGLTextureBlitter;
+  if ( !blitter_->create() ) {
+    LOG_ERROR( "OverlayManager: Failed to create texture blitter! Overlays will not be visible." );
+  }
   paint_device_ = new QOpenGLPaintDevice( size_ );
   if ( size_.width() == 0 || size_.height() == 0 ) {
     doneCurrent();
@@ -79,6 +84,7 @@ QOpenGLWrapper::~QOpenGLWrapper()
 {
   if ( opengl_context_ != nullptr ) {
     makeCurrent();
+    delete blitter_;
     delete paint_device_;
     delete surface_;
     delete fbo_;
@@ -114,19 +120,75 @@ void QOpenGLWrapper::doneCurrent()
 
 void QOpenGLWrapper::prepareRender()
 {
-  if ( paint_device_->size() != size() ) {
-    paint_device_->setSize( size() );
-    createFbo();
-  }
+  if ( fbo_ != nullptr && fbo_->size() == size() )
+    return;
+  paint_device_->setSize( size() );
+  createFbo();
+}
+
+void QOpenGLWrapper::beginLayer( const QSize &layer_size )
+{
+  QOpenGLFunctions *functions = opengl_context_->functions();
+  layer_size_ = layer_size;
   fbo_->bind();
-  opengl_context_->functions()->glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT );
+  // Layers with a reduced resolution are rendered into the bottom left of the framebuffer
+  paint_device_->setSize( layer_size_ );
+  functions->glViewport( 0, 0, layer_size_.width(), layer_size_.height() );
+  functions->glClearColor( 0, 0, 0, 0 );
+  functions->glClear( GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT );
 }
 
-void QOpenGLWrapper::finishRender()
+void QOpenGLWrapper::endLayer( std::unique_ptr<QOpenGLFramebufferObject> &layer )
 {
   fbo_->release();
+  paint_device_->setSize( size_ );
+  if ( layer == nullptr || layer->size() != layer_size_ ) {
+    QOpenGLFunctions *functions = opengl_context_->functions();
+    // Each overlay keeps a layer the size of the render panel (RGBA8, e.g., 33 MB at 4K) since its
+    // painted bounds are not known. Together with the full-screen blend per layer in composeLayer,
+    // this is the price for re-rendering only dirty overlays and deferring overlays over budget.
+    layer = std::make_unique<QOpenGLFramebufferObject>( layer_size_ );
+    functions->glBindTexture( GL_TEXTURE_2D, layer->texture() );
+    functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR );
+    functions->glTexParameteri( GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR );
+    functions->glBindTexture( GL_TEXTURE_2D, 0 );
+  }
+  const QRect rect( QPoint( 0, 0 ), layer_size_ );
+  QOpenGLFramebufferObject::blitFramebuffer( layer.get(), rect, fbo_, rect );
+}
+
+void QOpenGLWrapper::beginComposition()
+{
+  QOpenGLFunctions *functions = opengl_context_->functions();
+  texture_fbo_->bind();
+  // The overlays may have left state behind that would interfere with the composition
+  functions->glDisable( GL_SCISSOR_TEST );
+  functions->glDisable( GL_DEPTH_TEST );
+  functions->glDisable( GL_STENCIL_TEST );
+  functions->glViewport( 0, 0, size_.width(), size_.height() );
+  functions->glClearColor( 0, 0, 0, 0 );
+  functions->glClear( GL_COLOR_BUFFER_BIT );
+}
+
+void QOpenGLWrapper::composeLayer( const QOpenGLFramebufferObject &layer )
+{
+  QOpenGLFunctions *functions = opengl_context_->functions();
+  // The content rendered by Qt is premultiplied, hence, this is equivalent to drawing the overlays
+  // on top of each other in a single framebuffer
+  functions->glEnable( GL_BLEND );
+  functions->glBlendFunc( GL_ONE, GL_ONE_MINUS_SRC_ALPHA );
+  blitter_->bind();
+  // Both textures have their origin at the bottom left, hence, no flip. The layer is stretched to
+  // the viewport if it was rendered at a reduced resolution.
+  blitter_->blit( layer.texture(), QMatrix4x4(), QOpenGLTextureBlitter::OriginBottomLeft );
+  blitter_->release();
+  functions->glDisable( GL_BLEND );
+}
+
+void QOpenGLWrapper::finishRender()
+{
+  texture_fbo_->release();
   opengl_context_->functions()->glFinish();
-  QOpenGLFramebufferObject::blitFramebuffer( texture_fbo_, fbo_ );
 }
 
 const QSize &QOpenGLWrapper::size() const { return size_; }
@@ -21,10 +21,13 @@
 #include <QSize>
 #include <qopenglcontext.h>
 
+#include <memory>
+
 class QOpenGLContext;
 class QOpenGLPaintDevice;
 class QOffscreenSurface;
 class QOpenGLFramebufferObject;
+class QOpenGLTextureBlitter;
 class QPaintDevice;
 
 namespace hector_rviz_overlay
@@ -50,8 +53,29 @@ public:
 
   void doneCurrent();
 
+  //! Resizes the framebuffers if the size changed.
   void prepareRender();
 
+  /*!
+   * Binds and clears the multisampled framebuffer that overlays are rendered into.
+   * @param layer_size The size of the layer which may be smaller than the size if the layer is
+   *   rendered at a reduced resolution. The paint device and the viewport are set to this size.
+   */
+  void beginLayer( const QSize &layer_size );
+
+  /*!
+   * Resolves the multisampled framebuffer into the given layer. The layer is (re)created if it does
+   * not exist or has the wrong size. Layers use linear filtering, so that layers with a reduced
+   * resolution are upscaled smoothly when composed.
+   */
+  void endLayer( std::unique_ptr<QOpenGLFramebufferObject> &layer );
+
+  //! Binds and clears the framebuffer of the final texture.
+  void beginComposition();
+
+  //! Draws the given layer with premultiplied alpha blending on top of the final texture.
+  void composeLayer( const QOpenGLFramebufferObject &layer );
+
   void finishRender();
 
   const QSize &size() const;
@@ -70,12 +94,14 @@ private:
   void createFbo();
 
   QSize size_;
+  QSize layer_size_;
 
   QOpenGLContext *native_opengl_context_;
   QOpenGLContext *opengl_context_;
   QOffscreenSurface *surface_;
   QOpenGLFramebufferObject *fbo_, *texture_fbo_;
   QOpenGLPaintDevice *paint_device_;
+  QOpenGLTextureBlitter *blitter_;
 
   bool opengl_context_is_current_;
 
@@ -23,14 +23,20 @@
 #include <rviz_rendering/render_window.hpp>
 
 #include <Ogre.h>
+#include <OgreManualObject.h>
 #include <OgreRenderTargetListener.h>
+#include <OgreSceneManager.h>
+#include <OgreSceneNode.h>
 #include <Overlay/OgreOverlay.h>
-#include <Overlay/OgreOverlayContainer.h>
 #include <Overlay/OgreOverlayManager.h>
 #include <RenderSystems/GL/OgreGLTexture.h>
 
 #include "../logging.hpp"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
 namespace hector_rviz_overlay
 {
 
@@ -68,6 +74,20 @@ size_t bit_ceil( size_t value )
   return value + 1;
 #endif
 }
+
+bool isTransparent( const unsigned char *pixels, size_t bytes )
+{
+  // The alpha is premultiplied, hence, transparent pixels are all zero
+  uint64_t accumulated = 0;
+  size_t i = 0;
+  for ( ; i + sizeof( uint64_t ) <= bytes; i += sizeof( uint64_t ) ) {
+    uint64_t value;
+    std::memcpy( &value, pixels + i, sizeof( uint64_t ) );
+    accumulated |= value;
+  }
+  for ( ; i < bytes; ++i ) accumulated |= pixels[i];
+  return accumulated == 0;
+}
 } // namespace
 
 TextureOverlayRenderer::TextureOverlayRenderer( rviz_common::DisplayContext *context )
@@ -79,13 +99,21 @@ TextureOverlayRenderer::TextureOverlayRenderer( rviz_common::DisplayContext *con
   material_ = Ogre::MaterialManager::getSingleton().create(
       "hector_rviz_overlay/OverlayMaterial", Ogre::ResourceGroupManager::DEFAULT_RESOURCE_GROUP_NAME );
   material_->getTechnique( 0 )->getPass( 0 )->setSceneBlending( Ogre::SBT_TRANSPARENT_ALPHA );
-  overlay_panel_ = dynamic_cast<Ogre::OverlayContainer *>(
-      overlay_manager.createOverlayElement( "Panel", "hector_rviz_overlay/MainPanel" ) );
-  overlay_panel_->setPosition( 0.0, 0.0 );
-  overlay_panel_->setDimensions( 1.0, 1.0 );
-  overlay_panel_->setMaterial( material_ );
+  material_->setDepthCheckEnabled( false );
+  material_->setDepthWriteEnabled( false );
+  material_->setLightingEnabled( false );
+  material_->setCullingMode( Ogre::CULL_NONE );
 
-  ogre_overlay_->add2D( overlay_panel_ );
+  scene_manager_ = context->getSceneManager();
+  tile_mesh_ = scene_manager_->createManualObject( "hector_rviz_overlay/TileMesh" );
+  tile_mesh_->setDynamic( true );
+  // The vertices are specified in clip space
+  tile_mesh_->setUseIdentityProjection( true );
+  tile_mesh_->setUseIdentityView( true );
+  tile_node_ = scene_manager_->createSceneNode();
+  tile_node_->attachObject( tile_mesh_ );
+  // Rendered in the overlay queue and only while the Ogre overlay is shown
+  ogre_overlay_->add3D( tile_node_ );
 
   render_target_listener_ = new RenderTargetListener( this );
   rviz_rendering::RenderWindowOgreAdapter::addListener( render_panel_->getRenderWindow(),
@@ -103,9 +131,12 @@ TextureOverlayRenderer::~TextureOverlayRenderer()
   }
 
   ogre_overlay_->hide();
+  ogre_overlay_->remove3D( tile_node_ );
+  tile_node_->detachAllObjects();
+  scene_manager_->destroySceneNode( tile_node_ );
+  scene_manager_->destroyManualObject( tile_mesh_ );
   material_->unload();
   Ogre::OverlayManager::getSingleton().destroy( "hector_rviz_overlay/Overlay" );
-  Ogre::OverlayManager::getSingleton().destroyOverlayElement( overlay_panel_ );
   Ogre::MaterialManager::getSingleton().remove( material_->getName() );
   if ( texture_ != nullptr )
     Ogre::TextureManager::getSingleton().remove( texture_->getName() );
@@ -127,19 +158,103 @@ void TextureOverlayRenderer::prepareRender( int width, int height )
 {
   // Create or resize texture if necessary
   updateTexture( width, height );
-
-  if ( last_width_ != width || last_height_ != height ) {
-    last_width_ = width;
-    last_height_ = height;
-    overlay_panel_->setDimensions( (Ogre::Real)texture_->getWidth() / width,
-                                   (Ogre::Real)texture_->getHeight() / height );
-  }
+  // The tile mesh is rebuilt for the new size in updateTiles once the content was rendered
+  last_width_ = width;
+  last_height_ = height;
 }
 
 void TextureOverlayRenderer::finishRender() { ogre_overlay_->show(); }
 
 void TextureOverlayRenderer::hide() { ogre_overlay_->hide(); }
 
+void TextureOverlayRenderer::updateTiles( const unsigned char *data, int bytes_per_line,
+                                          bool bottom_up )
+{
+  const int width = last_width_;
+  const int height = last_height_;
+  if ( width <= 0 || height <= 0 )
+    return;
+  const int columns = ( width + TileSize - 1 ) / TileSize;
+  computeTileOccupancy( data, width, height, bytes_per_line, bottom_up, next_tile_occupancy_ );
+  if ( next_tile_occupancy_ == tile_occupancy_ && columns == tile_columns_ &&
+       mesh_width_ == width && mesh_height_ == height )
+    return;
+  tile_occupancy_.swap( next_tile_occupancy_ );
+  tile_columns_ = columns;
+  rebuildTileMesh();
+}
+
+void TextureOverlayRenderer::computeTileOccupancy( const unsigned char *data, int width,
+                                                   int height, int bytes_per_line, bool bottom_up,
+                                                   std::vector<unsigned char> &occupancy )
+{
+  const int columns = ( width + TileSize - 1 ) / TileSize;
+  const int rows = ( height + TileSize - 1 ) / TileSize;
+  occupancy.assign( columns * rows, 0 );
+  for ( int line = 0; line < height; ++line ) {
+    const int y = bottom_up ? height - 1 - line : line;
+    unsigned char *occupied = occupancy.data() + ( y / TileSize ) * columns;
+    const unsigned char *pixels = data + static_cast<size_t>( line ) * bytes_per_line;
+    for ( int column = 0; column < columns; ++column ) {
+      // Once a visible pixel was found, the remaining lines of the tile don't have to be checked
+      if ( occupied[column] )
+        continue;
+      const int left = column * TileSize;
+      const int count = std::min( TileSize, width - left );
+      occupied[column] = !isTransparent( pixels + left * 4, count * 4 );
+    }
+  }
+}
+
+void TextureOverlayRenderer::rebuildTileMesh()
+{
+  tile_mesh_->clear();
+  mesh_width_ = last_width_;
+  mesh_height_ = last_height_;
+  if ( !texture_ || tile_columns_ == 0 )
+    return;
+  const auto texture_width = static_cast<float>( texture_->getWidth() );
+  const auto texture_height = static_cast<float>( texture_->getHeight() );
+  auto addVertex = [&]( int x, int y ) {
+    tile_mesh_->position( 2.0f * x / mesh_width_ - 1.0f, 1.0f - 2.0f * y / mesh_height_, 0.0f );
+    // One texel per pixel with the origin at the top left like the texture's content
+    tile_mesh_->textureCoord( x / texture_width, y / texture_height );
+  };
+
+  const int rows = static_cast<int>( tile_occupancy_.size() ) / tile_columns_;
+  Ogre::uint32 index = 0;
+  for ( int row = 0; row < rows; ++row ) {
+    const unsigned char *occupied = tile_occupancy_.data() + row * tile_columns_;
+    const int top = row * TileSize;
+    const int bottom = std::min( top + TileSize, mesh_height_ );
+    for ( int column = 0; column < tile_columns_; ) {
+      if ( !occupied[column] ) {
+        ++column;
+        continue;
+      }
+      // Adjacent occupied tiles are drawn as a single quad
+      int end = column + 1;
+      while ( end < tile_columns_ && occupied[end] ) ++end;
+      if ( index == 0 )
+        tile_mesh_->begin( material_->getName(), Ogre::RenderOperation::OT_TRIANGLE_LIST );
+      const int left = column * TileSize;
+      const int right = std::min( end * TileSize, mesh_width_ );
+      addVertex( left, top );
+      addVertex( left, bottom );
+      addVertex( right, bottom );
+      addVertex( right, top );
+      tile_mesh_->quad( index, index + 1, index + 2, index + 3 );
+      index += 4;
+      column = end;
+    }
+  }
+  if ( index == 0 )
+    return;
+  tile_mesh_->end();
+  // The vertices are in clip space, hence, the mesh must never be culled
+  tile_mesh_->setBoundingBox( Ogre::AxisAlignedBox::BOX_INFINITE );
+}
+
 void TextureOverlayRenderer::updateTexture( unsigned int texture_width, unsigned int texture_height )
 {
   if ( texture_multiple_of_two_required_ ) {
@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/ui/gl_overlay.hpp"
+
+#include "hector_rviz_overlay/render/renderer.hpp"
+
+#include "../logging.hpp"
+
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+
+#include <stdexcept>
+
+#ifndef GL_VERTEX_ARRAY_BINDING
+#define GL_VERTEX_ARRAY_BINDING 0x85B5
+#endif
+
+namespace hector_rviz_overlay
+{
+
+namespace
+{
+/*!
+ * Saves the OpenGL state a custom draw typically changes on construction and restores it on
+ * destruction. Only uses glGet* and state setters, hence, the cost is a few dozen cheap calls.
+ */
+class GlStateGuard
+{
+public:
+  explicit GlStateGuard( QOpenGLContext *context ) : functions_( context->functions() )
+  {
+    // Vertex array objects are only part of the core API since OpenGL (ES) 3.0
+    if ( context->format().majorVersion() >= 3 )
+      extra_functions_ = context->extraFunctions();
+
+    for ( int i = 0; i < CapabilityCount; ++i )
+      capabilities_enabled_[i] = functions_->glIsEnabled( Capabilities[i] );
+    functions_->glGetIntegerv( GL_VIEWPORT, viewport_ );
+    functions_->glGetIntegerv( GL_SCISSOR_BOX, scissor_box_ );
+    functions_->glGetIntegerv( GL_BLEND_SRC_RGB, &blend_src_rgb_ );
+    functions_->glGetIntegerv( GL_BLEND_DST_RGB, &blend_dst_rgb_ );
+    functions_->glGetIntegerv( GL_BLEND_SRC_ALPHA, &blend_src_alpha_ );
+    functions_->glGetIntegerv( GL_BLEND_DST_ALPHA, &blend_dst_alpha_ );
+    functions_->glGetIntegerv( GL_BLEND_EQUATION_RGB, &blend_equation_rgb_ );
+    functions_->glGetIntegerv( GL_BLEND_EQUATION_ALPHA, &blend_equation_alpha_ );
+    functions_->glGetBooleanv( GL_COLOR_WRITEMASK, color_mask_ );
+    functions_->glGetBooleanv( GL_DEPTH_WRITEMASK, &depth_mask_ );
+    functions_->glGetIntegerv( GL_DEPTH_FUNC, &depth_func_ );
+    functions_->glGetFloatv( GL_COLOR_CLEAR_VALUE, clear_color_ );
+    functions_->glGetIntegerv( GL_CURRENT_PROGRAM, &program_ );
+    functions_->glGetIntegerv( GL_ARRAY_BUFFER_BINDING, &array_buffer_ );
+    functions_->glGetIntegerv( GL_ACTIVE_TEXTURE, &active_texture_ );
+    functions_->glActiveTexture( GL_TEXTURE0 );
+    functions_->glGetIntegerv( GL_TEXTURE_BINDING_2D, &texture_2d_ );
+    functions_->glGetIntegerv( GL_UNPACK_ALIGNMENT, &unpack_alignment_ );
+    functions_->glGetIntegerv( GL_FRAMEBUFFER_BINDING, &framebuffer_ );
+    if ( extra_functions_ != nullptr )
+      functions_->glGetIntegerv( GL_VERTEX_ARRAY_BINDING, &vertex_array_ );
+    // The element array buffer is part of the vertex array state, hence, restored with it
+  }
+
+  ~GlStateGuard()
+  {
+    if ( extra_functions_ != nullptr )
+      extra_functions_->glBindVertexArray( vertex_array_ );
+    functions_->glBindFramebuffer( GL_FRAMEBUFFER, framebuffer_ );
+    functions_->glPixelStorei( GL_UNPACK_ALIGNMENT, unpack_alignment_ );
+    functions_->glActiveTexture( GL_TEXTURE0 );
+    functions_->glBindTexture( GL_TEXTURE_2D, texture_2d_ );
+    functions_->glActiveTexture( active_texture_ );
+    functions_->glBindBuffer( GL_ARRAY_BUFFER, array_buffer_ );
+    functions_->glUseProgram( program_ );
+    functions_->glClearColor( clear_color_[0], clear_color_[1], clear_color_[2], clear_color_[3] );
+    functions_->glDepthFunc( depth_func_ );
+    functions_->glDepthMask( depth_mask_ );
+    functions_->glColorMask( color_mask_[0], color_mask_[1], color_mask_[2], color_mask_[3] );
+    functions_->glBlendEquationSeparate( blend_equation_rgb_, blend_equation_alpha_ );
+    functions_->glBlendFuncSeparate( blend_src_rgb_, blend_dst_rgb_, blend_src_alpha_,
+                                     blend_dst_alpha_ );
+    functions_->glScissor( scissor_box_[0], scissor_box_[1], scissor_box_[2], scissor_box_[3] );
+    functions_->glViewport( viewport_[0], viewport_[1], viewport_[2], viewport_[3] );
+    for ( int i = 0; i < CapabilityCount; ++i ) {
+      if ( capabilities_enabled_[i] )
+        functions_->glEnable( Capabilities[i] );
+      else
+        functions_->glDisable( Capabilities[i] );
+    }
+  }
+
+private:
+  static constexpr int CapabilityCount = 5;
+  static constexpr GLenum Capabilities[CapabilityCount] = {
+      GL_BLEND, GL_DEPTH_TEST, GL_SCISSOR_TEST, GL_STENCIL_TEST, GL_CULL_FACE };
+
+  QOpenGLFunctions *functions_;
+  QOpenGLExtraFunctions *extra_functions_ = nullptr;
+  GLboolean capabilities_enabled_[CapabilityCount] = {};
+  GLint viewport_[4] = {};
+  GLint scissor_box_[4] = {};
+  GLint blend_src_rgb_ = GL_ONE, blend_dst_rgb_ = GL_ZERO;
+  GLint blend_src_alpha_ = GL_ONE, blend_dst_alpha_ = GL_ZERO;
+  GLint blend_equation_rgb_ = GL_FUNC_ADD, blend_equation_alpha_ = GL_FUNC_ADD;
+  GLboolean color_mask_[4] = { GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE };
+  GLboolean depth_mask_ = GL_TRUE;
+  GLint depth_func_ = GL_LESS;
+  GLfloat clear_color_[4] = {};
+  GLint program_ = 0;
+  GLint array_buffer_ = 0;
+  GLint active_texture_ = GL_TEXTURE0;
+  GLint texture_2d_ = 0;
+  GLint unpack_alignment_ = 4;
+  GLint framebuffer_ = 0;
+  GLint vertex_array_ = 0;
+};
+
+constexpr GLenum GlStateGuard::Capabilities[];
+} // namespace
+
+GlOverlay::GlOverlay( const std::string &name ) : UiOverlay( name ) { }
+
+GlOverlay::~GlOverlay() = default;
+
+void GlOverlay::prepareRender( Renderer *renderer )
+{
+  if ( context_ != nullptr )
+    return;
+
+  try {
+    context_ = renderer->context();
+  } catch ( std::logic_error &ex ) {
+    LOG_ERROR( "GlOverlay '%s' requires an OpenGL renderer and will not be drawn! Reason: %s",
+               name().c_str(), ex.what() );
+    return;
+  }
+  initializeGl( context_ );
+}
+
+void GlOverlay::releaseRenderResources()
+{
+  if ( context_ == nullptr )
+    return;
+  releaseGl( context_ );
+  context_ = nullptr;
+}
+
+void GlOverlay::renderImpl( Renderer *renderer )
+{
+  if ( context_ == nullptr )
+    return;
+
+  QOpenGLFramebufferObject *framebuffer = renderer->framebufferObject();
+  GlStateGuard state_guard( context_ );
+  framebuffer->bind();
+  context_->functions()->glViewport( 0, 0, framebuffer->width(), framebuffer->height() );
+  paintGl( context_, framebuffer );
+}
+} // namespace hector_rviz_overlay
@@ -0,0 +1,107 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/ui/painter_overlay.hpp"
+
+#include "hector_rviz_overlay/render/renderer.hpp"
+
+#include <QPainter>
+
+namespace hector_rviz_overlay
+{
+
+PainterOverlay::Frame::Frame( PainterOverlay *overlay, std::unique_lock<std::mutex> lock )
+    : overlay_( overlay ), lock_( std::move( lock ) ),
+      commands_( &overlay->command_lists_[overlay->back_index_] )
+{
+  commands_->clear();
+}
+
+PainterOverlay::Frame::Frame( Frame &&other ) noexcept
+    : overlay_( other.overlay_ ), lock_( std::move( other.lock_ ) ), commands_( other.commands_ )
+{
+  other.overlay_ = nullptr;
+  other.commands_ = nullptr;
+}
+
+PainterOverlay::Frame::~Frame()
+{
+  // The lock is released after the list was published
+  if ( overlay_ != nullptr )
+    overlay_->publish();
+}
+
+PainterOverlay::PainterOverlay( const std::string &name ) : UiOverlay( name ) { }
+
+PainterOverlay::~PainterOverlay() = default;
+
+PainterOverlay::Frame PainterOverlay::beginFrame()
+{
+  return Frame( this, std::unique_lock<std::mutex>( producer_mutex_ ) );
+}
+
+void PainterOverlay::clear() { beginFrame(); }
+
+void PainterOverlay::publish()
+{
+  // Called with the producer mutex held
+  int previous = shared_index_.exchange( back_index_ | NewFrameFlag, std::memory_order_acq_rel );
+  // If the previous frame was never picked up, it is dropped and recorded over
+  back_index_ = previous & IndexMask;
+  requestRender();
+}
+
+QSize PainterOverlay::contentSize() const
+{
+  return { content_width_.load( std::memory_order_relaxed ),
+           content_height_.load( std::memory_order_relaxed ) };
+}
+
+void PainterOverlay::setScale( float value )
+{
+  Overlay::setScale( value );
+  updateContentSize();
+}
+
+void PainterOverlay::setGeometry( const QRect &value )
+{
+  Overlay::setGeometry( value );
+  updateContentSize();
+}
+
+void PainterOverlay::updateContentSize()
+{
+  content_width_.store( (int)( geometry().width() / scale() ), std::memory_order_relaxed );
+  content_height_.store( (int)( geometry().height() / scale() ), std::memory_order_relaxed );
+}
+
+void PainterOverlay::renderImpl( Renderer *renderer )
+{
+  if ( shared_index_.load( std::memory_order_acquire ) & NewFrameFlag ) {
+    int previous = shared_index_.exchange( front_index_, std::memory_order_acq_rel );
+    front_index_ = previous & IndexMask;
+  }
+  const PainterCommandList &commands = command_lists_[front_index_];
+  if ( commands.empty() )
+    return;
+  QPainter painter( renderer->paintDevice() );
+  painter.setRenderHints( QPainter::Antialiasing | QPainter::TextAntialiasing );
+  const float render_scale = scale() * renderer->resolutionScale();
+  painter.scale( render_scale, render_scale );
+  commands.replay( painter );
+}
+} // namespace hector_rviz_overlay
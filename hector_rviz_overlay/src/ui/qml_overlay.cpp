@@ -22,9 +22,13 @@
 #include "hector_rviz_overlay/helper/rviz_tool_icon_provider.hpp"
 #include "hector_rviz_overlay/overlay_manager.hpp"
 #include "hector_rviz_overlay/path_helper.hpp"
+#include "hector_rviz_overlay/qml/qml_types.hpp"
+#include "hector_rviz_overlay/render/frame_animation_driver.hpp"
 #include "hector_rviz_overlay/render/renderer.hpp"
 
 #include <QApplication>
+#include <QKeyEvent>
+#include <QMouseEvent>
 #include <QOffscreenSurface>
 #include <QOpenGLFramebufferObject>
 #include <QOpenGLFunctions>
@@ -36,8 +40,12 @@
 #include <QQuickItem>
 #include <QQuickRenderControl>
 #include <QQuickWindow>
+#include <QWheelEvent>
 #include <QWidget>
 
+#include <algorithm>
+#include <cmath>
+
 #include <rviz_common/display_context.hpp>
 
 #include "../logging.hpp"
@@ -67,14 +75,48 @@ private:
   QmlOverlay *overlay_;
 };
 
+/*!
+ * The scene is shown in rviz' window, hence, the quick window has the focus if that window has the
+ * focus. Otherwise, the quick window never gets an active focus item and key events are dropped.
+ */
+class QmlOverlay::RenderControl : public QQuickRenderControl
+{
+public:
+  explicit RenderControl( QmlOverlay *overlay ) : overlay_( overlay ) { }
+
+  QWindow *renderWindow( QPoint *offset ) override
+  {
+    if ( offset != nullptr )
+      *offset = overlay_->geometry().topLeft();
+    QWindow *window = topLevel( overlay_->rviz_window_ );
+    // The focus window may be a native child window of rviz' window, e.g., the 3D view
+    QWindow *focus_window = QGuiApplication::focusWindow();
+    if ( window != nullptr && topLevel( focus_window ) == window )
+      return focus_window;
+    return window;
+  }
+
+private:
+  static QWindow *topLevel( QWindow *window )
+  {
+    while ( window != nullptr && window->parent() != nullptr ) window = window->parent();
+    return window;
+  }
+
+  QmlOverlay *overlay_;
+};
+
 QmlOverlay::QmlOverlay( const std::string &name ) : UiOverlay( name )
 {
   qRegisterMetaType<QmlOverlay::Status>();
   connect( this, &Overlay::visibilityChanged, this, &QmlOverlay::onVisibilityChanged );
+  connect( this, &Overlay::hiddenPolicyChanged, this, &QmlOverlay::updateAnimationSuspension );
 }
 
 QmlOverlay::~QmlOverlay()
 {
+  if ( animation_driver_acquired_ )
+    FrameAnimationDriver::release();
   delete url_interceptor_;
   delete qml_rviz_context_;
 }
@@ -110,7 +152,13 @@ void QmlOverlay::prepareRender( Renderer *renderer )
   }
   rviz_window_ = renderer->window();
 
-  render_control_ = new QQuickRenderControl();
+  // Install before any animation is started so that they are driven by the rendered frames
+  FrameAnimationDriver::acquire();
+  animation_driver_acquired_ = true;
+
+  registerQmlTypes();
+
+  render_control_ = new RenderControl( this );
   quick_window_ = new QQuickWindow( render_control_ );
 
   engine_ = new QQmlEngine( quick_window_ );
@@ -120,19 +168,24 @@ void QmlOverlay::prepareRender( Renderer *renderer )
   engine_->setUrlInterceptor( url_interceptor_ );
   if ( !engine_->incubationController() )
     engine_->setIncubationController( quick_window_->incubationController() );
-  qml_rviz_context_ =
-      new QmlRvizContext( OverlayManager::getSingleton().displayContext(), this, false );
-  qml_rviz_context_->setConfig( configuration_ );
-  emit contextCreated();
-  engine_->rootContext()->setContextProperty( "rviz", qml_rviz_context_ );
-  auto *tool_icon_provider =
-      new RvizToolIconProvider( OverlayManager::getSingleton().displayContext()->getToolManager() );
-  engine_->addImageProvider( QLatin1String( "rviz_tool_icons" ), tool_icon_provider );
+  // Without a display context, e.g., in the headless benchmark, the rviz context is not available
+  rviz_common::DisplayContext *display_context = OverlayManager::getSingleton().displayContext();
+  if ( display_context != nullptr ) {
+    // The context is kept when the render resources are released since it owns the properties
+    if ( qml_rviz_context_ == nullptr ) {
+      qml_rviz_context_ = new QmlRvizContext( display_context, this, false );
+      qml_rviz_context_->setConfig( configuration_ );
+      emit contextCreated();
+    }
+    engine_->rootContext()->setContextProperty( "rviz", qml_rviz_context_ );
+    auto *tool_icon_provider = new RvizToolIconProvider( display_context->getToolManager() );
+    engine_->addImageProvider( QLatin1String( "rviz_tool_icons" ), tool_icon_provider );
+  }
 
   component_ = new QQmlComponent( engine_ );
 
   quick_window_->contentItem()->setTransformOrigin( QQuickItem::TopLeft );
-  quick_window_->contentItem()->setScale( scale() );
+  quick_window_->contentItem()->setScale( scale() * resolution_scale_ );
   quick_window_->setColor( Qt::transparent );
   quick_window_->setClearBeforeRendering( false );
   quick_window_->setPersistentOpenGLContext( true );
@@ -150,18 +203,38 @@ void QmlOverlay::prepareRender( Renderer *renderer )
   if ( isVisible() ) {
     QShowEvent event;
     QApplication::sendEvent( quick_window_, &event );
-    qml_rviz_context_->setVisible( true );
+    if ( qml_rviz_context_ != nullptr )
+      qml_rviz_context_->setVisible( true );
   }
 }
 
 void QmlOverlay::releaseRenderResources()
 {
+  if ( animation_driver_acquired_ ) {
+    FrameAnimationDriver::release();
+    animation_driver_acquired_ = false;
+  }
+  if ( render_control_ == nullptr )
+    return;
+  // Keep the configuration to restore it when the resources are created again
+  if ( qml_rviz_context_ != nullptr ) {
+    configuration_ = qml_rviz_context_->config();
+    qml_rviz_context_->setVisible( false );
+  }
+  // Same order as in Qt's render control example. The root item is deleted with the content item
+  // of the window and the engine is a child of the window.
   delete render_control_;
-  qml_rviz_context_ = nullptr;
+  delete component_;
+  delete quick_window_;
   render_control_ = nullptr;
   component_ = nullptr;
   quick_window_ = nullptr;
   engine_ = nullptr;
+  root_item_ = nullptr;
+  // Destroyed with the scene
+  paused_animations_.clear();
+  stopped_timers_.clear();
+  scene_changed_ = true;
 }
 
 void QmlOverlay::renderImpl( Renderer *renderer )
@@ -173,9 +246,22 @@ void QmlOverlay::renderImpl( Renderer *renderer )
     reload();
   }
 
-  if ( quick_window_->renderTarget() != renderer->framebufferObject() ||
-       renderer->framebufferObjectUpdated() ) {
-    quick_window_->setRenderTarget( renderer->framebufferObject() );
+  QOpenGLFramebufferObject *framebuffer = renderer->framebufferObject();
+  const float resolution_scale = renderer->resolutionScale();
+  if ( resolution_scale != resolution_scale_ ) {
+    // The scene keeps its logical size and is drawn at the reduced scale into the layer
+    resolution_scale_ = resolution_scale;
+    quick_window_->contentItem()->setScale( scale() * resolution_scale_ );
+    scene_changed_ = true;
+  }
+  // The layer is the bottom left part of the framebuffer with the same size as computed by the
+  // renderer. The quick window sets up its viewport and projection for the render target's size.
+  const QSize target_size(
+      std::max( 1, (int)std::lround( framebuffer->width() * resolution_scale_ ) ),
+      std::max( 1, (int)std::lround( framebuffer->height() * resolution_scale_ ) ) );
+  if ( quick_window_->renderTargetId() != framebuffer->handle() ||
+       quick_window_->renderTargetSize() != target_size || renderer->framebufferObjectUpdated() ) {
+    quick_window_->setRenderTarget( framebuffer->handle(), target_size );
   }
   if ( scene_changed_ ) {
     // According to https://youtu.be/FamAKvkfzxM?t=2247, polish and sync should be called when QQuickRenderControl emits sceneUpdated
@@ -187,45 +273,6 @@ void QmlOverlay::renderImpl( Renderer *renderer )
   renderer->context()->functions()->glFlush();
 }
 
-namespace
-{
-bool sendKeyEventToFocusedItems( QObject *obj, QEvent *event )
-{
-  auto *item = qobject_cast<QQuickItem *>( obj );
-  if ( !item ) {
-    for ( auto &child : obj->children() ) {
-      if ( sendKeyEventToFocusedItems( child, event ) )
-        return true;
-    }
-    return event->isAccepted();
-  }
-  for ( auto &child : item->childItems() ) {
-    if ( sendKeyEventToFocusedItems( child, event ) )
-      return true;
-  }
-
-  if ( !item->hasFocus() )
-    return event->isAccepted();
-  // Check that it isnt in an inactive focus scope
-  auto *current = item;
-  while ( current != nullptr ) {
-    if ( current->isFocusScope() && current->parentItem() != nullptr && !current->hasFocus() )
-      return event->isAccepted();
-    current = current->parentItem();
-  }
-  // It is not, so deliver to it
-  current = item;
-  while ( current != nullptr ) {
-    QCoreApplication::sendEvent( current, event );
-    if ( event->isAccepted() )
-      break;
-    current = current->parentItem();
-  }
-  //  if ( current != nullptr ) ROS_INFO_STREAM( current->metaObject()->className() << " accepted" );
-  return event->isAccepted();
-}
-} // namespace
-
 bool QmlOverlay::handleEvent( QObject *, QEvent *event )
 {
   if ( render_control_ == nullptr )
@@ -235,14 +282,14 @@ bool QmlOverlay::handleEvent( QObject *, QEvent *event )
   sending_event_ = true;
   event->ignore();
 
-  if ( event->type() != QEvent::KeyPress && event->type() != QEvent::KeyRelease ) {
-    QCoreApplication::sendEvent( quick_window_, event );
-    if ( event->isAccepted() )
-      quick_window_->contentItem()->setFocus( true );
-  } else {
-    sendKeyEventToFocusedItems( quick_window_, event );
-    //    ROS_INFO("Event was accepted: %s", event->isAccepted() ? "true" : "false");
-  }
+  // The window delivers key events to its active focus item and, until accepted, to its parents,
+  // hence, the cost does not depend on the size of the scene. FocusIn and FocusOut sent by the
+  // OverlayManager when the overlay gains or loses the focus update the active focus item.
+  sendEventToWindow( event );
+  const QEvent::Type type = event->type();
+  if ( event->isAccepted() && type != QEvent::KeyPress && type != QEvent::KeyRelease &&
+       type != QEvent::FocusIn && type != QEvent::FocusOut )
+    quick_window_->contentItem()->setFocus( true );
   // A bit of a hack, if the overlay changed the cursor, we consume the mouse move events to prevent rviz from overwriting it
   if ( rviz_window_ != nullptr && quick_window_->cursor().shape() != Qt::ArrowCursor ) {
     event->accept();
@@ -252,6 +299,48 @@ bool QmlOverlay::handleEvent( QObject *, QEvent *event )
   return event->isAccepted();
 }
 
+void QmlOverlay::sendEventToWindow( QEvent *event )
+{
+  if ( resolution_scale_ == 1 ) {
+    QCoreApplication::sendEvent( quick_window_, event );
+    return;
+  }
+  // The content item is scaled by the resolution scale, hence, positions in the render panel have
+  // to be scaled to the window's coordinates as well
+  switch ( event->type() ) {
+  case QEvent::MouseMove:
+  case QEvent::MouseButtonPress:
+  case QEvent::MouseButtonRelease:
+  case QEvent::MouseButtonDblClick: {
+    auto *mouse_event = static_cast<QMouseEvent *>( event );
+    QMouseEvent scaled_event( mouse_event->type(), mouse_event->localPos() * resolution_scale_,
+                              mouse_event->windowPos() * resolution_scale_,
+                              mouse_event->screenPos(), mouse_event->button(),
+                              mouse_event->buttons(), mouse_event->modifiers(),
+                              mouse_event->source() );
+    scaled_event.setAccepted( event->isAccepted() );
+    QCoreApplication::sendEvent( quick_window_, &scaled_event );
+    event->setAccepted( scaled_event.isAccepted() );
+    return;
+  }
+  case QEvent::Wheel: {
+    auto *wheel_event = static_cast<QWheelEvent *>( event );
+    QWheelEvent scaled_event( wheel_event->position() * resolution_scale_,
+                              wheel_event->globalPosition(), wheel_event->pixelDelta(),
+                              wheel_event->angleDelta(), wheel_event->buttons(),
+                              wheel_event->modifiers(), wheel_event->phase(),
+                              wheel_event->inverted(), wheel_event->source() );
+    scaled_event.setAccepted( event->isAccepted() );
+    QCoreApplication::sendEvent( quick_window_, &scaled_event );
+    event->setAccepted( scaled_event.isAccepted() );
+    return;
+  }
+  default:
+    QCoreApplication::sendEvent( quick_window_, event );
+    return;
+  }
+}
+
 void QmlOverlay::setGeometry( const QRect &value )
 {
   Overlay::setGeometry( value );
@@ -267,7 +356,7 @@ void QmlOverlay::setScale( float value )
   if ( quick_window_ == nullptr )
     return;
 
-  quick_window_->contentItem()->setScale( value );
+  quick_window_->contentItem()->setScale( value * resolution_scale_ );
   updateGeometry();
 }
 
@@ -331,7 +420,8 @@ bool QmlOverlay::createRootItem()
   delete component_;
   component_ = new QQmlComponent( engine_ );
 
-  component_->loadUrl( QUrl( resolvePath( path_ ) ) );
+  // Precompiled resources can't be watched, hence, prefer the installed file for live reloading
+  component_->loadUrl( resolveQmlUrl( path_, live_reload_enabled_ ) );
   if ( component_->isError() ) {
     LOG_WARN( "Error while trying to load QML: %s", component_->errorString().toStdString().c_str() );
     setStatus( LoadingFailed );
@@ -359,6 +449,7 @@ bool QmlOverlay::createRootItem()
   root_item_->setParent( quick_window_->contentItem() );
   root_item_->setTransformOrigin( QQuickItem::TopLeft );
   updateGeometry();
+  updateAnimationSuspension();
   setStatus( Ok );
   // Have to manually set scene changed since the reload won't trigger an event
   scene_changed_ = true;
@@ -432,11 +523,64 @@ void QmlOverlay::onVisibilityChanged()
       QApplication::sendEvent( quick_window_, &event );
     }
   }
+  updateAnimationSuspension();
   if ( qml_rviz_context_ == nullptr )
     return;
   qml_rviz_context_->setVisible( isVisible() );
 }
 
+void QmlOverlay::updateAnimationSuspension()
+{
+  // The renderer no longer updates suspended overlays but the animation driver is shared by all
+  // overlays, hence, the animations of the scene have to be paused explicitly.
+  if ( !isVisible() && hiddenPolicy() != KeepWarm )
+    suspendAnimations();
+  else
+    resumeAnimations();
+}
+
+void QmlOverlay::suspendAnimations()
+{
+  if ( root_item_ == nullptr )
+    return;
+  for ( QObject *object : root_item_->findChildren<QObject *>() ) {
+    if ( object->inherits( "QQmlTimer" ) ) {
+      if ( !object->property( "running" ).toBool() )
+        continue;
+      object->setProperty( "running", false );
+      stopped_timers_.emplace_back( object );
+      continue;
+    }
+    if ( !object->inherits( "QQuickAbstractAnimation" ) )
+      continue;
+    // Only top-level animations can be paused. Animations in groups are paused with their group and
+    // the ones of Behaviors and Transitions are controlled by those and short-lived anyway.
+    QObject *parent = object->parent();
+    if ( parent != nullptr &&
+         ( parent->inherits( "QQuickAbstractAnimation" ) || parent->inherits( "QQuickBehavior" ) ||
+           parent->inherits( "QQuickTransition" ) ) )
+      continue;
+    if ( !object->property( "running" ).toBool() || object->property( "paused" ).toBool() )
+      continue;
+    object->setProperty( "paused", true );
+    paused_animations_.emplace_back( object );
+  }
+}
+
+void QmlOverlay::resumeAnimations()
+{
+  for ( const QPointer<QObject> &animation : paused_animations_ ) {
+    if ( animation != nullptr )
+      animation->setProperty( "paused", false );
+  }
+  for ( const QPointer<QObject> &timer : stopped_timers_ ) {
+    if ( timer != nullptr )
+      timer->setProperty( "running", true );
+  }
+  paused_animations_.clear();
+  stopped_timers_.clear();
+}
+
 QmlRvizContext *QmlOverlay::context() { return qml_rviz_context_; }
 
 const QQmlEngine *QmlOverlay::engine() const { return engine_; }
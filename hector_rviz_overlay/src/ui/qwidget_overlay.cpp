@@ -22,18 +22,61 @@
 #include "hector_rviz_overlay/render/renderer.hpp"
 
 #include <QPainter>
+#include <QPicture>
+#include <QRunnable>
+#include <QThreadPool>
 
 namespace hector_rviz_overlay
 {
 
+namespace
+{
+class PictureRasterJob : public QRunnable
+{
+public:
+  PictureRasterJob( QPicture picture, QImage *target, const QImage *last, float scale,
+                    std::promise<bool> promise )
+      : picture_( std::move( picture ) ), target_( target ), last_( last ), scale_( scale ),
+        promise_( std::move( promise ) )
+  {
+  }
+
+  void run() override
+  {
+    target_->fill( Qt::transparent );
+    {
+      QPainter painter( target_ );
+      painter.scale( scale_, scale_ );
+      picture_.play( &painter );
+    }
+    // The last image is only read by the GUI thread until the result was collected
+    promise_.set_value( *target_ != *last_ );
+  }
+
+private:
+  QPicture picture_;
+  QImage *target_;
+  const QImage *last_;
+  float scale_;
+  std::promise<bool> promise_;
+};
+} // namespace
+
 QWidgetOverlay::QWidgetOverlay( const std::string &name ) : UiOverlay( name )
 {
   widget_ = new OverlayWidget;
+  // In the raster modes, the widget is shown without a window to track its damage.
+  widget_->setAttribute( Qt::WA_DontShowOnScreen );
+  widget_->setAttribute( Qt::WA_QuitOnClose, false );
+  widget_->installEventFilter( this );
   event_manager_ = new QWidgetEventManager( widget_ );
 }
 
 QWidgetOverlay::~QWidgetOverlay()
 {
+  // The worker writes into the back image
+  if ( raster_result_.valid() )
+    raster_result_.wait();
   delete event_manager_;
   delete widget_;
 }
@@ -59,11 +102,123 @@ void QWidgetOverlay::setGeometry( const QRect &value )
                                (int)( geometry().height() / scale() ) ) );
 }
 
+void QWidgetOverlay::setRenderMode( RenderMode value )
+{
+  if ( value == render_mode_ )
+    return;
+  if ( raster_result_.valid() )
+    raster_result_.wait();
+  raster_result_ = std::future<bool>();
+  render_mode_ = value;
+  // Free the images or make sure the first update rasterizes
+  raster_image_ = QImage();
+  back_image_ = QImage();
+  time_since_raster_ = std::numeric_limits<float>::infinity();
+  widget_->setVisible( render_mode_ != Direct );
+  requestRender();
+}
+
+bool QWidgetOverlay::eventFilter( QObject *watched, QEvent *event )
+{
+  // Posted to the visible top level widget whenever it or one of its children called update().
+  // It has to be delivered, otherwise the widget would not request further updates.
+  if ( watched == widget_ && event->type() == QEvent::UpdateRequest )
+    damaged_ = true;
+  return UiOverlay::eventFilter( watched, event );
+}
+
+void QWidgetOverlay::releaseRenderResources()
+{
+  if ( raster_result_.valid() )
+    raster_result_.wait();
+  raster_result_ = std::future<bool>();
+  // Rasterized again on the next update
+  raster_image_ = QImage();
+  back_image_ = QImage();
+}
+
+void QWidgetOverlay::update( float dt )
+{
+  if ( render_mode_ == Direct )
+    return;
+  if ( render_mode_ == ParallelRaster )
+    collectParallelRaster();
+  time_since_raster_ += dt;
+  if ( maxUpdateRate() > 0 && time_since_raster_ < 1.0f / maxUpdateRate() )
+    return;
+
+  const QSize size = geometry().size() * resolution_scale_;
+  const float raster_scale = scale() * resolution_scale_;
+  if ( size.isEmpty() )
+    return;
+  // Nothing was updated and the last image is still valid, skip recording and rasterizing
+  if ( !damaged_ && raster_image_.size() == size && raster_scale == last_raster_scale_ )
+    return;
+  damaged_ = false;
+  last_raster_scale_ = raster_scale;
+  time_since_raster_ = 0;
+  if ( render_mode_ == ParallelRaster ) {
+    QPicture picture;
+    {
+      QPainter painter( &picture );
+      widget_->renderContent( &painter );
+    }
+    // A widget may call update() without changing, hence, the recording is played back and the
+    // result compared to avoid rendering and uploading the same content.
+    if ( back_image_.size() != size )
+      back_image_ = QImage( size, QImage::Format_ARGB32_Premultiplied );
+    std::promise<bool> promise;
+    raster_result_ = promise.get_future();
+    // The jobs of all overlays run in parallel to each other and to the rendering of the frame
+    QThreadPool::globalInstance()->start( new PictureRasterJob(
+        std::move( picture ), &back_image_, &raster_image_, raster_scale, std::move( promise ) ) );
+    return;
+  }
+  if ( back_image_.size() != size )
+    back_image_ = QImage( size, QImage::Format_ARGB32_Premultiplied );
+  back_image_.fill( Qt::transparent );
+  {
+    QPainter painter( &back_image_ );
+    painter.scale( raster_scale, raster_scale );
+    widget_->renderContent( &painter );
+  }
+  if ( back_image_ == raster_image_ )
+    return;
+  // Swapping keeps both buffers, so rasterizing does not allocate while the size stays the same
+  raster_image_.swap( back_image_ );
+  requestRender();
+}
+
+void QWidgetOverlay::collectParallelRaster()
+{
+  if ( !raster_result_.valid() )
+    return;
+  // Started in the last update, hence, usually finished already
+  bool changed = raster_result_.get();
+  if ( !changed )
+    return;
+  raster_image_.swap( back_image_ );
+  requestRender();
+}
+
 void QWidgetOverlay::renderImpl( Renderer *renderer )
 {
+  resolution_scale_ = renderer->resolutionScale();
   QPainter painter( renderer->paintDevice() );
-  painter.scale( scale(), scale() );
-  widget_->render( &painter );
+  if ( render_mode_ != Direct ) {
+    const QSize size = geometry().size() * resolution_scale_;
+    // The OpenGL paint engine caches the texture of the image until the image is modified
+    if ( raster_image_.size() == size ) {
+      painter.drawImage( 0, 0, raster_image_ );
+      return;
+    }
+    // The resolution changed, the image is rasterized at the new resolution in the next update
+    painter.setRenderHint( QPainter::SmoothPixmapTransform );
+    painter.drawImage( QRect( QPoint( 0, 0 ), size ), raster_image_ );
+    return;
+  }
+  painter.scale( scale() * resolution_scale_, scale() * resolution_scale_ );
+  widget_->renderContent( &painter );
 }
 
 void QWidgetOverlay::handleEventsCanceled() { event_manager_->handleEventsCanceled(); }
@@ -75,7 +230,9 @@ bool QWidgetOverlay::handleEvent( QObject *receiver, QEvent *event )
 
 bool QWidgetOverlay::isDirty() const
 {
-  // Widgets are always dirty since there is currently no reliable way of finding out whether that's true
-  return true;
+  // In the raster modes, update checks whether the content changed.
+  // Otherwise, widgets are always dirty since there is currently no reliable way of finding out
+  // whether that's true.
+  return render_mode_ == Direct || Overlay::isDirty();
 }
 } // namespace hector_rviz_overlay
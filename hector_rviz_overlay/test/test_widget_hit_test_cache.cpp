@@ -0,0 +1,122 @@
+/*
+ * Copyright (C) 2026  Stefan Fabian
+ *
+ * This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "hector_rviz_overlay/events/widget_hit_test_cache.hpp"
+#include "hector_rviz_overlay/overlay_widget.hpp"
+
+#include <QApplication>
+#include <QHBoxLayout>
+#include <QImage>
+#include <QPushButton>
+
+#include <gtest/gtest.h>
+
+#include <memory>
+
+using namespace hector_rviz_overlay;
+
+namespace
+{
+class QtEnvironment : public testing::Environment
+{
+public:
+  void SetUp() override
+  {
+    if ( qEnvironmentVariableIsEmpty( "QT_QPA_PLATFORM" ) )
+      qputenv( "QT_QPA_PLATFORM", "offscreen" );
+    app_ = std::make_unique<QApplication>( argc_, argv_ );
+  }
+
+  void TearDown() override { app_.reset(); }
+
+private:
+  int argc_ = 1;
+  char name_[32] = "test_widget_hit_test_cache";
+  char *argv_[2] = { name_, nullptr };
+  std::unique_ptr<QApplication> app_;
+};
+
+testing::Environment *const qt_environment =
+    testing::AddGlobalTestEnvironment( new QtEnvironment );
+
+//! Lays out the hidden widget the same way the overlays do when they render it.
+void render( QWidget &widget )
+{
+  QImage image( widget.size(), QImage::Format_ARGB32_Premultiplied );
+  widget.render( &image );
+}
+
+class WidgetHitTestCacheTest : public testing::Test
+{
+protected:
+  void SetUp() override
+  {
+    root_ = std::make_unique<OverlayWidget>();
+    layout_ = new QHBoxLayout( root_.get() );
+    layout_->setContentsMargins( 0, 0, 0, 0 );
+    layout_->setSpacing( 0 );
+    left_ = new QPushButton( "Left" );
+    right_ = new QPushButton( "Right" );
+    layout_->addWidget( left_ );
+    layout_->addWidget( right_ );
+    root_->resize( 200, 100 );
+    render( *root_ );
+  }
+
+  std::unique_ptr<OverlayWidget> root_;
+  QHBoxLayout *layout_ = nullptr;
+  QPushButton *left_ = nullptr;
+  QPushButton *right_ = nullptr;
+};
+} // namespace
+
+TEST_F( WidgetHitTestCacheTest, childAtMatchesInitialLayout )
+{
+  WidgetHitTestCache cache( root_.get() );
+  EXPECT_EQ( cache.childAt( QPoint( 50, 50 ) ), left_ );
+  EXPECT_EQ( cache.childAt( QPoint( 150, 50 ) ), right_ );
+  EXPECT_EQ( cache.childAt( QPoint( 250, 50 ) ), nullptr );
+}
+
+TEST_F( WidgetHitTestCacheTest, childAtAfterResizingHiddenRoot )
+{
+  WidgetHitTestCache cache( root_.get() );
+  ASSERT_EQ( cache.childAt( QPoint( 150, 50 ) ), right_ );
+
+  // The root is hidden like the widget of an overlay, hence, no Resize event is sent
+  root_->resize( 400, 100 );
+  render( *root_ );
+  ASSERT_EQ( right_->geometry().left(), 200 );
+  EXPECT_EQ( cache.childAt( QPoint( 150, 50 ) ), left_ );
+  QPoint local_pos;
+  EXPECT_EQ( cache.childAt( QPoint( 300, 50 ), &local_pos ), right_ );
+  EXPECT_EQ( local_pos, right_->mapFrom( root_.get(), QPoint( 300, 50 ) ) );
+}
+
+TEST_F( WidgetHitTestCacheTest, childAtAfterLayoutPass )
+{
+  WidgetHitTestCache cache( root_.get() );
+  ASSERT_EQ( cache.childAt( QPoint( 50, 50 ) ), left_ );
+
+  // Only the children are moved by the layout when the widget is rendered
+  layout_->setContentsMargins( 100, 0, 0, 0 );
+  render( *root_ );
+  ASSERT_EQ( left_->geometry().left(), 100 );
+  EXPECT_EQ( cache.childAt( QPoint( 50, 50 ) ), nullptr );
+  EXPECT_EQ( cache.childAt( QPoint( 120, 50 ) ), left_ );
+  EXPECT_EQ( cache.mapFromRoot( left_, QPoint( 120, 50 ) ), QPoint( 20, 50 - left_->y() ) );
+}